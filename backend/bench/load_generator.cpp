@@ -0,0 +1,431 @@
+// Drives a running subway_server with concurrent requests and reports latency histograms, throughput and errors.
+// Requests either replay a JSON lines trace or are drawn from a weighted mix of endpoints with random stations.
+// Usage: load_generator [--host 127.0.0.1] [--port 8080] [--concurrency 8] [--rate 0] [--duration 10]
+//                       [--requests 0] [--mix find-route=90,compare-algorithms=10] [--trace trace.jsonl]
+//                       [--csv ../../data/subway_travel_times.csv] [--json report.json] [--seed 3530]
+//
+// Trace lines look like {"path": "/api/find-route", "body": {"start_station": "...", "end_station": "...",
+// "time": "08:30"}}; "method" defaults to POST when there is a body and GET otherwise. The trace is replayed
+// in order and repeated until the duration or request count runs out.
+//
+// With --rate the requests are sent on a fixed schedule and latency is measured from when each request was
+// due, not when it was sent, so a server that falls behind shows its queueing delay (no coordinated omission).
+// Without it every connection sends its next request as soon as the previous one is answered.
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "httplib.h"
+#include "json.hpp"
+#include "../include/AdjacencyList.h"
+#include "../include/LatencyHistogram.h"
+
+using json = nlohmann::json;
+
+namespace {
+
+struct Options {
+    std::string host = "127.0.0.1";
+    int port = 8080;
+    int concurrency = 8;
+    double rate = 0.0;          // requests per second over all connections, 0 = as fast as answered
+    double duration = 10.0;     // seconds
+    long long requests = 0;     // stop after this many requests when above 0
+    std::string mix = "find-route=90,compare-algorithms=10";
+    std::string trace_path;
+    std::string csv_path = "../../data/subway_travel_times.csv";
+    std::string json_path;
+    unsigned int seed = 3530;
+};
+
+struct PlannedRequest {
+    std::string method;
+    std::string path;
+    std::string body;
+    std::size_t endpoint;       // index into the endpoint stats
+};
+
+// Outcomes of every request sent to one path. Shared by all connections
+struct EndpointStats {
+    std::string path;
+    LatencyHistogram latency_us;   // from when the request was due until the response arrived
+    LatencyHistogram service_us;   // from when the request was sent until the response arrived
+    std::atomic<std::uint64_t> ok{0};
+    std::atomic<std::uint64_t> http_errors{0};       // answered with a non-2xx status
+    std::atomic<std::uint64_t> transport_errors{0};  // connection failed, timed out or was dropped
+
+    explicit EndpointStats(std::string endpoint_path) : path(std::move(endpoint_path)) {}
+};
+
+const char* kUsage =
+    "Usage: load_generator [--host HOST] [--port PORT] [--concurrency N] [--rate REQ_PER_SEC]\n"
+    "                      [--duration SECONDS] [--requests N] [--mix ENDPOINT=WEIGHT,...]\n"
+    "                      [--trace FILE.jsonl] [--csv FILE.csv] [--json REPORT.json] [--seed N]\n"
+    "Mix endpoints: find-route, compare-algorithms, health\n";
+
+bool ParseOptions(int argc, char* argv[], Options& options, std::string& error) {
+    for (int i = 1; i < argc; ++i) {
+        const std::string flag = argv[i];
+        if (flag == "--help" || flag == "-h") {
+            error = kUsage;
+            return false;
+        }
+        if (i + 1 >= argc) {
+            error = "Missing value for " + flag;
+            return false;
+        }
+        const std::string value = argv[++i];
+        try {
+            if (flag == "--host") options.host = value;
+            else if (flag == "--port") options.port = std::stoi(value);
+            else if (flag == "--concurrency") options.concurrency = std::max(1, std::stoi(value));
+            else if (flag == "--rate") options.rate = std::max(0.0, std::stod(value));
+            else if (flag == "--duration") options.duration = std::max(0.0, std::stod(value));
+            else if (flag == "--requests") options.requests = std::max(0LL, std::stoll(value));
+            else if (flag == "--mix") options.mix = value;
+            else if (flag == "--trace") options.trace_path = value;
+            else if (flag == "--csv") options.csv_path = value;
+            else if (flag == "--json") options.json_path = value;
+            else if (flag == "--seed") options.seed = static_cast<unsigned int>(std::stoul(value));
+            else {
+                error = "Unknown option " + flag + "\n" + kUsage;
+                return false;
+            }
+        } catch (const std::exception&) {
+            error = "Invalid value for " + flag + ": " + value;
+            return false;
+        }
+    }
+    if (options.duration <= 0 && options.requests == 0) {
+        error = "Either --duration or --requests has to be above 0";
+        return false;
+    }
+    return true;
+}
+
+// Index of the stats for path, adding them on first use
+std::size_t EndpointFor(const std::string& path, std::vector<std::unique_ptr<EndpointStats>>& endpoints) {
+    for (std::size_t i = 0; i < endpoints.size(); ++i) {
+        if (endpoints[i]->path == path) {
+            return i;
+        }
+    }
+    endpoints.push_back(std::make_unique<EndpointStats>(path));
+    return endpoints.size() - 1;
+}
+
+bool LoadTrace(const std::string& trace_path, std::vector<PlannedRequest>& plan,
+               std::vector<std::unique_ptr<EndpointStats>>& endpoints, std::string& error) {
+    std::ifstream file(trace_path);
+    if (!file) {
+        error = "Cannot open trace " + trace_path;
+        return false;
+    }
+    std::string line;
+    int line_number = 0;
+    while (std::getline(file, line)) {
+        ++line_number;
+        if (line.find_first_not_of(" \t\r") == std::string::npos) {
+            continue;
+        }
+        try {
+            const json entry = json::parse(line);
+            PlannedRequest request;
+            request.path = entry.at("path").get<std::string>();
+            if (entry.contains("body")) {
+                request.body = entry["body"].is_string() ? entry["body"].get<std::string>() : entry["body"].dump();
+            }
+            request.method = entry.value("method", request.body.empty() ? "GET" : "POST");
+            if (request.method != "GET" && request.method != "POST") {
+                error = trace_path + ":" + std::to_string(line_number) + ": unsupported method " + request.method;
+                return false;
+            }
+            request.endpoint = EndpointFor(request.path, endpoints);
+            plan.push_back(std::move(request));
+        } catch (const json::exception& exception) {
+            error = trace_path + ":" + std::to_string(line_number) + ": " + exception.what();
+            return false;
+        }
+    }
+    if (plan.empty()) {
+        error = "Trace " + trace_path + " has no requests";
+        return false;
+    }
+    return true;
+}
+
+// Draws plan_size requests from the weighted endpoint mix, between random stations at random times of day
+bool BuildMixPlan(const Options& options, std::size_t plan_size, std::vector<PlannedRequest>& plan,
+                  std::vector<std::unique_ptr<EndpointStats>>& endpoints, std::string& error) {
+    std::vector<std::string> names;
+    std::vector<double> weights;
+    std::stringstream mix(options.mix);
+    std::string item;
+    while (std::getline(mix, item, ',')) {
+        const std::size_t equals = item.find('=');
+        const std::string name = item.substr(0, equals);
+        if (name != "find-route" && name != "compare-algorithms" && name != "health") {
+            error = "Unknown endpoint in --mix: " + name;
+            return false;
+        }
+        try {
+            weights.push_back(equals == std::string::npos ? 1.0 : std::stod(item.substr(equals + 1)));
+        } catch (const std::exception&) {
+            error = "Invalid weight in --mix: " + item;
+            return false;
+        }
+        names.push_back(name);
+    }
+    if (names.empty()) {
+        error = "--mix names no endpoints";
+        return false;
+    }
+
+    AdjacencyList adj_list;
+    adj_list.LoadFromCSV(options.csv_path, CsvLoadMode::Parallel);
+    std::vector<std::string> stations;
+    for (int station_id = 0; station_id < adj_list.GetStationCount(); ++station_id) {
+        stations.push_back(adj_list.GetStation(station_id)->station_name);
+    }
+    if (stations.empty()) {
+        error = "No stations loaded from " + options.csv_path + " (pass --csv, or replay a --trace)";
+        return false;
+    }
+
+    std::mt19937 generator(options.seed);
+    std::discrete_distribution<std::size_t> pick_endpoint(weights.begin(), weights.end());
+    std::uniform_int_distribution<std::size_t> pick_station(0, stations.size() - 1);
+    std::uniform_int_distribution<int> pick_minute(0, 24 * 60 - 1);
+    for (std::size_t i = 0; i < plan_size; ++i) {
+        const std::string& name = names[pick_endpoint(generator)];
+        PlannedRequest request;
+        if (name == "health") {
+            request.method = "GET";
+            request.path = "/health";
+        } else {
+            const int minute = pick_minute(generator);
+            char time[16];
+            std::snprintf(time, sizeof(time), "%02d:%02d", minute / 60, minute % 60);
+            request.method = "POST";
+            request.path = "/api/" + name;
+            request.body = json({
+                {"start_station", stations[pick_station(generator)]},
+                {"end_station", stations[pick_station(generator)]},
+                {"time", time}
+            }).dump();
+        }
+        request.endpoint = EndpointFor(request.path, endpoints);
+        plan.push_back(std::move(request));
+    }
+    return true;
+}
+
+// Sends requests on one keep-alive connection until the shared request counter or the clock runs out
+void RunConnection(const Options& options, const std::vector<PlannedRequest>& plan,
+                   std::vector<std::unique_ptr<EndpointStats>>& endpoints, std::atomic<long long>& next_request,
+                   std::chrono::steady_clock::time_point start_time, std::chrono::steady_clock::time_point end_time) {
+    httplib::Client client(options.host, options.port);
+    client.set_keep_alive(true);
+    client.set_tcp_nodelay(true);
+    client.set_connection_timeout(5);
+    client.set_read_timeout(30);
+    client.set_write_timeout(30);
+
+    while (true) {
+        const long long index = next_request.fetch_add(1, std::memory_order_relaxed);
+        if (options.requests > 0 && index >= options.requests) {
+            break;
+        }
+        // Requests follow a global schedule when rate limited, so each one has a due time independent of
+        // how long the ones before it took
+        std::chrono::steady_clock::time_point due_time = std::chrono::steady_clock::now();
+        if (options.rate > 0) {
+            due_time = start_time + std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                                        std::chrono::duration<double>(index / options.rate));
+            std::this_thread::sleep_until(due_time);
+        }
+        if (options.duration > 0 && due_time >= end_time) {
+            break;
+        }
+
+        const PlannedRequest& request = plan[static_cast<std::size_t>(index) % plan.size()];
+        EndpointStats& stats = *endpoints[request.endpoint];
+        const auto send_time = std::chrono::steady_clock::now();
+        httplib::Result result = request.method == "GET"
+            ? client.Get(request.path)
+            : client.Post(request.path, request.body, "application/json");
+        const auto receive_time = std::chrono::steady_clock::now();
+
+        if (!result) {
+            stats.transport_errors.fetch_add(1, std::memory_order_relaxed);
+            continue;
+        }
+        (result->status >= 200 && result->status < 300 ? stats.ok : stats.http_errors)
+            .fetch_add(1, std::memory_order_relaxed);
+        stats.latency_us.Record(
+            std::chrono::duration_cast<std::chrono::microseconds>(receive_time - due_time).count());
+        stats.service_us.Record(
+            std::chrono::duration_cast<std::chrono::microseconds>(receive_time - send_time).count());
+    }
+}
+
+const double kPercentiles[] = {50.0, 75.0, 90.0, 95.0, 99.0, 99.9, 99.99, 100.0};
+
+json HistogramJson(const LatencyHistogram& histogram) {
+    json percentiles = json::object();
+    for (double percentile : kPercentiles) {
+        char label[16];
+        std::snprintf(label, sizeof(label), "p%g", percentile);
+        percentiles[label] = histogram.ValueAtPercentile(percentile);
+    }
+    return {
+        {"count", histogram.GetCount()},
+        {"min_us", histogram.GetMin()},
+        {"mean_us", histogram.GetMean()},
+        {"max_us", histogram.GetMax()},
+        {"percentiles_us", percentiles}
+    };
+}
+
+void PrintRow(const std::string& name, const LatencyHistogram& latency, std::uint64_t ok, std::uint64_t http_errors,
+              std::uint64_t transport_errors, double seconds) {
+    const std::uint64_t total = ok + http_errors + transport_errors;
+    std::printf("%-28s %9llu %9.1f %7.2f%% %9.2f %9.2f %9.2f %9.2f\n", name.c_str(),
+                static_cast<unsigned long long>(total), total / seconds,
+                total > 0 ? 100.0 * (http_errors + transport_errors) / total : 0.0,
+                latency.ValueAtPercentile(50) / 1000.0, latency.ValueAtPercentile(90) / 1000.0,
+                latency.ValueAtPercentile(99) / 1000.0, latency.GetMax() / 1000.0);
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    Options options;
+    std::string error;
+    if (!ParseOptions(argc, argv, options, error)) {
+        std::cerr << error << std::endl;
+        return error == kUsage ? 0 : 1;
+    }
+
+    std::vector<PlannedRequest> plan;
+    std::vector<std::unique_ptr<EndpointStats>> endpoints;
+    const bool planned = options.trace_path.empty()
+        ? BuildMixPlan(options, 10000, plan, endpoints, error)
+        : LoadTrace(options.trace_path, plan, endpoints, error);
+    if (!planned) {
+        std::cerr << error << std::endl;
+        return 1;
+    }
+
+    // Fail fast if nothing is listening rather than reporting a run made only of transport errors
+    httplib::Client probe(options.host, options.port);
+    probe.set_connection_timeout(2);
+    if (!probe.Get("/health")) {
+        std::cerr << "No server answering at " << options.host << ":" << options.port << std::endl;
+        return 1;
+    }
+
+    std::printf("%zu planned requests over %zu endpoints, %d connections, ", plan.size(), endpoints.size(),
+                options.concurrency);
+    if (options.rate > 0) {
+        std::printf("%.1f requests/s, ", options.rate);
+    } else {
+        std::printf("unthrottled, ");
+    }
+    if (options.requests > 0) {
+        std::printf("%lld requests\n", options.requests);
+    } else {
+        std::printf("%.1f s\n", options.duration);
+    }
+
+    std::atomic<long long> next_request{0};
+    const auto start_time = std::chrono::steady_clock::now();
+    const auto end_time = start_time + std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                                           std::chrono::duration<double>(options.duration));
+    std::vector<std::thread> connections;
+    for (int i = 0; i < options.concurrency; ++i) {
+        connections.emplace_back(RunConnection, std::cref(options), std::cref(plan), std::ref(endpoints),
+                                 std::ref(next_request), start_time, end_time);
+    }
+    for (std::thread& connection : connections) {
+        connection.join();
+    }
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start_time).count();
+
+    // Totals over every endpoint
+    LatencyHistogram total_latency;
+    LatencyHistogram total_service;
+    std::uint64_t total_ok = 0;
+    std::uint64_t total_http_errors = 0;
+    std::uint64_t total_transport_errors = 0;
+    for (const auto& endpoint : endpoints) {
+        total_latency.Merge(endpoint->latency_us);
+        total_service.Merge(endpoint->service_us);
+        total_ok += endpoint->ok;
+        total_http_errors += endpoint->http_errors;
+        total_transport_errors += endpoint->transport_errors;
+    }
+
+    std::printf("\n%-28s %9s %9s %8s %9s %9s %9s %9s\n", "endpoint", "requests", "req/s", "errors", "p50_ms",
+                "p90_ms", "p99_ms", "max_ms");
+    for (const auto& endpoint : endpoints) {
+        PrintRow(endpoint->path, endpoint->latency_us, endpoint->ok, endpoint->http_errors, endpoint->transport_errors,
+                 seconds);
+    }
+    PrintRow("all", total_latency, total_ok, total_http_errors, total_transport_errors, seconds);
+
+    std::printf("\nLatency distribution, all endpoints (ms)\n");
+    std::printf("%10s %12s %12s\n", "percentile", "latency", "service");
+    for (double percentile : kPercentiles) {
+        std::printf("%10g %12.3f %12.3f\n", percentile, total_latency.ValueAtPercentile(percentile) / 1000.0,
+                    total_service.ValueAtPercentile(percentile) / 1000.0);
+    }
+    std::printf("\n%llu ok, %llu HTTP errors, %llu transport errors in %.2f s\n",
+                static_cast<unsigned long long>(total_ok), static_cast<unsigned long long>(total_http_errors),
+                static_cast<unsigned long long>(total_transport_errors), seconds);
+
+    if (!options.json_path.empty()) {
+        json endpoint_reports = json::array();
+        for (const auto& endpoint : endpoints) {
+            endpoint_reports.push_back({
+                {"path", endpoint->path},
+                {"ok", endpoint->ok.load()},
+                {"http_errors", endpoint->http_errors.load()},
+                {"transport_errors", endpoint->transport_errors.load()},
+                {"latency", HistogramJson(endpoint->latency_us)},
+                {"service_time", HistogramJson(endpoint->service_us)}
+            });
+        }
+        const json report = {
+            {"host", options.host},
+            {"port", options.port},
+            {"concurrency", options.concurrency},
+            {"rate", options.rate},
+            {"seconds", seconds},
+            {"throughput", (total_ok + total_http_errors + total_transport_errors) / seconds},
+            {"ok", total_ok},
+            {"http_errors", total_http_errors},
+            {"transport_errors", total_transport_errors},
+            {"latency", HistogramJson(total_latency)},
+            {"service_time", HistogramJson(total_service)},
+            {"endpoints", endpoint_reports}
+        };
+        std::ofstream output(options.json_path);
+        if (!output) {
+            std::cerr << "Cannot write " << options.json_path << std::endl;
+            return 1;
+        }
+        output << report.dump(2) << std::endl;
+        std::printf("Wrote %s\n", options.json_path.c_str());
+    }
+    return total_transport_errors + total_http_errors > 0 ? 2 : 0;
+}
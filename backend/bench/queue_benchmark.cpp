@@ -0,0 +1,92 @@
+// Compares the priority queue implementations behind Dijkstra and AStar on the real network.
+// Usage: queue_benchmark [csv_path] [pairs_per_slice]
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <iostream>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "../include/AdjacencyList.h"
+#include "../include/AStar.h"
+#include "../include/Dijkstra.h"
+#include "../include/LandmarkTable.h"
+#include "../include/PriorityQueue.h"
+
+namespace {
+
+struct Query {
+    TimeSlice slice;
+    int start_id;
+    int end_id;
+};
+
+// Runs every query through the engine and prints one result row
+template <typename Engine>
+void RunBenchmark(const char* engine_name, QueueType queue_type, const Engine& engine,
+                  const std::vector<Query>& queries) {
+    SearchStats stats;
+    double checksum = 0.0;
+    const auto start_time = std::chrono::steady_clock::now();
+    for (const Query& query : queries) {
+        const double travel_time = engine.GetQuickestPath(query.slice, query.start_id, query.end_id, &stats).first;
+        // Unreachable pairs return infinity, which would hide any difference between queues
+        if (std::isfinite(travel_time)) {
+            checksum += travel_time;
+        }
+    }
+    const auto end_time = std::chrono::steady_clock::now();
+
+    const double query_count = static_cast<double>(queries.size());
+    const double total_us = std::chrono::duration<double, std::micro>(end_time - start_time).count();
+    std::printf("%-9s %-16s %12.1f %12.1f %12.1f %12.1f %12.2f   (checksum %.2f)\n",
+                engine_name, QueueTypeName(queue_type), stats.pushes / query_count,
+                stats.decrease_keys / query_count, stats.pops / query_count, stats.settled / query_count,
+                total_us / query_count, checksum);
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    const std::string csv_path = argc > 1 ? argv[1] : "../../data/subway_travel_times.csv";
+    const int pairs_per_slice = argc > 2 ? std::stoi(argv[2]) : 200;
+
+    AdjacencyList adj_list;
+    adj_list.LoadFromCSV(csv_path, CsvLoadMode::Parallel);
+    if (adj_list.GetStationCount() == 0) {
+        std::cerr << "No stations loaded from " << csv_path << std::endl;
+        return 1;
+    }
+
+    // The same random origin-destination pairs for every slice, engine, and queue
+    std::mt19937 generator(3530);
+    std::uniform_int_distribution<int> pick_station(0, adj_list.GetStationCount() - 1);
+    std::vector<Query> queries;
+    for (TimeSlice slice : adj_list.GetTimeSlices()) {
+        for (int i = 0; i < pairs_per_slice; ++i) {
+            queries.push_back({slice, pick_station(generator), pick_station(generator)});
+        }
+    }
+
+    std::printf("%zu queries over %zu time slices\n\n", queries.size(), adj_list.GetTimeSlices().size());
+    std::printf("%-9s %-16s %12s %12s %12s %12s %12s\n",
+                "engine", "queue", "pushes/q", "decreases/q", "pops/q", "settled/q", "us/query");
+    for (QueueType queue_type : {QueueType::BinaryHeap, QueueType::QuaternaryHeap, QueueType::RadixHeap}) {
+        RunBenchmark("dijkstra", queue_type, Dijkstra(&adj_list, queue_type), queries);
+    }
+    for (QueueType queue_type : {QueueType::BinaryHeap, QueueType::QuaternaryHeap, QueueType::RadixHeap}) {
+        RunBenchmark("astar", queue_type, AStar(&adj_list, queue_type), queries);
+    }
+
+    // A* again with landmark lower bounds instead of the coordinate heuristic
+    LandmarkTable landmarks(&adj_list);
+    landmarks.Build();
+    for (QueueType queue_type : {QueueType::BinaryHeap, QueueType::QuaternaryHeap, QueueType::RadixHeap}) {
+        AStar engine(&adj_list, queue_type);
+        engine.SetLandmarks(&landmarks);
+        RunBenchmark("astar_alt", queue_type, engine, queries);
+    }
+    return 0;
+}
@@ -0,0 +1,220 @@
+// Measures Dijkstra and A* on the real network, one time slice at a time, and writes the results as JSON
+// so two commits can be compared with a plain diff.
+// Usage: route_benchmark [csv_path] [pairs_per_slice] [json_path]
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <new>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "json.hpp"
+#include "../include/AdjacencyList.h"
+#include "../include/AStar.h"
+#include "../include/Dijkstra.h"
+#include "../include/LandmarkTable.h"
+
+using json = nlohmann::json;
+
+// Every allocation of the process goes through these, so the benchmark can count the ones a query makes
+namespace {
+std::atomic<std::uint64_t> allocation_count{0};
+std::atomic<std::uint64_t> allocated_bytes{0};
+}  // namespace
+
+void* operator new(std::size_t size) {
+    allocation_count.fetch_add(1, std::memory_order_relaxed);
+    allocated_bytes.fetch_add(size, std::memory_order_relaxed);
+    if (void* pointer = std::malloc(size == 0 ? 1 : size)) {
+        return pointer;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* pointer) noexcept { std::free(pointer); }
+void operator delete(void* pointer, std::size_t) noexcept { std::free(pointer); }
+
+namespace {
+
+struct Query {
+    TimeSlice slice;
+    int start_id;
+    int end_id;
+};
+
+// Cost of one query
+struct Sample {
+    double latency_us;
+    std::uint64_t settled;
+    std::uint64_t allocations;
+    std::uint64_t bytes;
+};
+
+// Percentile of already sorted values, nearest rank
+double Percentile(const std::vector<double>& sorted, double fraction) {
+    if (sorted.empty()) {
+        return 0.0;
+    }
+    const std::size_t rank = static_cast<std::size_t>(std::ceil(fraction * sorted.size()));
+    return sorted[std::min(sorted.size() - 1, rank == 0 ? 0 : rank - 1)];
+}
+
+// Latency percentiles and per query averages of a group of samples
+json Summarize(const std::vector<Sample>& samples) {
+    std::vector<double> latencies;
+    double settled = 0.0;
+    double allocations = 0.0;
+    double bytes = 0.0;
+    for (const Sample& sample : samples) {
+        latencies.push_back(sample.latency_us);
+        settled += sample.settled;
+        allocations += sample.allocations;
+        bytes += sample.bytes;
+    }
+    std::sort(latencies.begin(), latencies.end());
+    const double count = std::max<double>(1.0, samples.size());
+    double total_us = 0.0;
+    for (double latency : latencies) {
+        total_us += latency;
+    }
+    // Rounded so repeated runs diff cleanly; the counts are exact and the latencies are noisy anyway
+    auto round_to = [](double value, double scale) { return std::round(value * scale) / scale; };
+    return {
+        {"queries", samples.size()},
+        {"p50_us", round_to(Percentile(latencies, 0.50), 100)},
+        {"p99_us", round_to(Percentile(latencies, 0.99), 100)},
+        {"mean_us", round_to(total_us / count, 100)},
+        {"settled_per_query", round_to(settled / count, 100)},
+        {"allocations_per_query", round_to(allocations / count, 100)},
+        {"bytes_per_query", round_to(bytes / count, 10)}
+    };
+}
+
+// Runs every query through the engine once untimed to warm the thread's search scratch, then once timed,
+// and returns the overall summary, the checksum of the travel times found, and a summary per slice
+template <typename Engine>
+json RunBenchmark(const char* engine_name, const char* pair_set, const Engine& engine,
+                  const std::vector<Query>& queries) {
+    for (const Query& query : queries) {
+        engine.GetQuickestPath(query.slice, query.start_id, query.end_id);
+    }
+
+    std::vector<Sample> samples;
+    samples.reserve(queries.size());
+    double checksum = 0.0;
+    for (const Query& query : queries) {
+        SearchStats stats;
+        const std::uint64_t allocations_before = allocation_count.load(std::memory_order_relaxed);
+        const std::uint64_t bytes_before = allocated_bytes.load(std::memory_order_relaxed);
+        const auto start_time = std::chrono::steady_clock::now();
+        const double travel_time = engine.GetQuickestPath(query.slice, query.start_id, query.end_id, &stats).first;
+        const auto end_time = std::chrono::steady_clock::now();
+        samples.push_back({std::chrono::duration<double, std::micro>(end_time - start_time).count(), stats.settled,
+                           allocation_count.load(std::memory_order_relaxed) - allocations_before,
+                           allocated_bytes.load(std::memory_order_relaxed) - bytes_before});
+        // Unreachable pairs return infinity or -1, which would hide any difference between commits
+        if (std::isfinite(travel_time) && travel_time >= 0) {
+            checksum += travel_time;
+        }
+    }
+
+    json result = Summarize(samples);
+    result["engine"] = engine_name;
+    result["pairs"] = pair_set;
+    result["checksum"] = std::round(checksum * 100.0) / 100.0;
+
+    // Queries are grouped by slice, so each slice is one contiguous run of samples
+    json slices = json::array();
+    std::size_t begin = 0;
+    while (begin < queries.size()) {
+        std::size_t end = begin;
+        while (end < queries.size() && queries[end].slice == queries[begin].slice) {
+            ++end;
+        }
+        const std::array<std::string, 3> key = queries[begin].slice.ToCompositeKey();
+        json slice = Summarize(std::vector<Sample>(samples.begin() + begin, samples.begin() + end));
+        slice["slice"] = key[0] + "/" + key[1] + "/" + key[2];
+        slices.push_back(slice);
+        begin = end;
+    }
+    result["slices"] = slices;
+
+    std::printf("%-9s %-7s %9zu %10.2f %10.2f %10.2f %12.1f %12.2f %12.1f\n", engine_name, pair_set,
+                queries.size(), result["p50_us"].get<double>(), result["p99_us"].get<double>(),
+                result["mean_us"].get<double>(), result["settled_per_query"].get<double>(),
+                result["allocations_per_query"].get<double>(), result["bytes_per_query"].get<double>());
+    return result;
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    const std::string csv_path = argc > 1 ? argv[1] : "../../data/subway_travel_times.csv";
+    const int pairs_per_slice = argc > 2 ? std::stoi(argv[2]) : 100;
+    const std::string json_path = argc > 3 ? argv[3] : "route_benchmark.json";
+
+    AdjacencyList adj_list;
+    adj_list.LoadFromCSV(csv_path, CsvLoadMode::Parallel);
+    if (adj_list.GetStationCount() == 0) {
+        std::cerr << "No stations loaded from " << csv_path << std::endl;
+        return 1;
+    }
+    const int station_count = adj_list.GetStationCount();
+    const std::vector<TimeSlice> slices = adj_list.GetTimeSlices();
+
+    // Random pairs are drawn afresh for every slice from a fixed seed. Fixed pairs are the same on every slice,
+    // spread over the station IDs and each going to the station halfway round, so slices compare directly
+    std::mt19937 generator(3530);
+    std::uniform_int_distribution<int> pick_station(0, station_count - 1);
+    std::vector<Query> random_queries;
+    std::vector<Query> fixed_queries;
+    for (TimeSlice slice : slices) {
+        for (int i = 0; i < pairs_per_slice; ++i) {
+            random_queries.push_back({slice, pick_station(generator), pick_station(generator)});
+            const int start_id = static_cast<int>(static_cast<long long>(i) * station_count / pairs_per_slice);
+            fixed_queries.push_back({slice, start_id, (start_id + station_count / 2) % station_count});
+        }
+    }
+
+    LandmarkTable landmarks(&adj_list);
+    landmarks.Build();
+    const Dijkstra dijkstra(&adj_list);
+    const AStar astar(&adj_list);
+    AStar astar_alt(&adj_list);
+    astar_alt.SetLandmarks(&landmarks);
+
+    std::printf("%d stations, %zu time slices, %d pairs per slice\n\n", station_count, slices.size(),
+                pairs_per_slice);
+    std::printf("%-9s %-7s %9s %10s %10s %10s %12s %12s %12s\n", "engine", "pairs", "queries", "p50_us",
+                "p99_us", "mean_us", "settled/q", "allocs/q", "bytes/q");
+    json results = json::array();
+    for (const auto* pairs : {&random_queries, &fixed_queries}) {
+        const char* pair_set = pairs == &random_queries ? "random" : "fixed";
+        results.push_back(RunBenchmark("dijkstra", pair_set, dijkstra, *pairs));
+        results.push_back(RunBenchmark("astar", pair_set, astar, *pairs));
+        results.push_back(RunBenchmark("astar_alt", pair_set, astar_alt, *pairs));
+    }
+
+    const json report = {
+        {"csv_path", csv_path},
+        {"stations", station_count},
+        {"time_slices", slices.size()},
+        {"pairs_per_slice", pairs_per_slice},
+        {"results", results}
+    };
+    std::ofstream output(json_path);
+    if (!output) {
+        std::cerr << "Cannot write " << json_path << std::endl;
+        return 1;
+    }
+    output << report.dump(2) << std::endl;
+    std::printf("\nWrote %s\n", json_path.c_str());
+    return 0;
+}
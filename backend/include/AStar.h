@@ -1,8 +1,10 @@
 #pragma once
 
 #include "AdjacencyList.h"
-#include <queue>
-#include <unordered_map>
+#include "LandmarkTable.h"
+#include "PriorityQueue.h"
+#include "SearchScratch.h"
+#include "SearchTrace.h"
 #include <vector>
 #include <cmath>
 
@@ -11,34 +13,40 @@ using namespace std;
 class AStar {
 
 private:
-    struct Node {
-        int station_id;
-        double g_cost;
-        double f_cost;
-
-        bool operator>(const Node& other) const {
-            return f_cost > other.f_cost;
-        }
-    };
-
     array<string, 3> composite_key_; //composite with month, time, week
+    TimeSlice slice_; //composite_key_ parsed once when it is set
     AdjacencyList* adj_lists_;
 
-    unordered_map<int, vector<Edge>>* adj_list_; 
+    QueueType queue_type_; //open set queue, borrowed from the calling thread's scratch with the g costs
+    const LandmarkTable* landmarks_; //landmark lower bounds, used instead of the coordinates when set
 
-    unordered_map<int, vector<Edge>>* GetAdjacencyList() const;
     double Heuristic(const Station& a, const Station& b) const; //calculation from the longitude and latitude
 
     //same as get path from dijkstra class
-    vector<Station> ReconstructPath(unordered_map<int, int>& predecessors, int start_id, int end_id) const;
+    vector<Station> ReconstructPath(const SearchState& state, int start_id, int end_id) const;
+
+    //the search itself, every step is reported to trace (NullTrace compiles the reporting away)
+    template <typename Trace>
+    pair<double, vector<Station>> Search(TimeSlice slice, int start_id, int end_id, SearchStats* stats,
+                                         Trace& trace) const;
 
 public:
-    explicit AStar(AdjacencyList* adj_lists)
-        : composite_key_({}), adj_lists_(adj_lists), adj_list_(nullptr) {}
-//gets the adj list of composite key
+    explicit AStar(AdjacencyList* adj_lists, QueueType queue_type = QueueType::QuaternaryHeap)
+        : composite_key_({}), adj_lists_(adj_lists), queue_type_(queue_type), landmarks_(nullptr) {}
+//sets the composite key used by the station overload of GetQuickestPath
     void SetCompositeKey(const array<string, 3>& key);
-
-
+    void SetTimeSlice(TimeSlice slice);
+    //switches the heuristic to landmark (ALT) lower bounds for every slice the table covers
+    //the table has to outlive the engine, nullptr goes back to the coordinate heuristic
+    void SetLandmarks(const LandmarkTable* landmarks) { landmarks_ = landmarks; }
+
+    //thread safe search of the slice's graph, stats are filled in if not null
+    pair<double, vector<Station>> GetQuickestPath(TimeSlice slice, int start_id, int end_id,
+                                                  SearchStats* stats = nullptr) const;
+    //same search, recording the settle order, relaxations and queue operations in trace
+    pair<double, vector<Station>> GetQuickestPath(TimeSlice slice, int start_id, int end_id, RecordingTrace& trace,
+                                                  SearchStats* stats = nullptr) const;
+    //searches the stored composite key, not safe to share between threads that set different keys
     pair<double, vector<Station>> GetQuickestPath(const Station& start_station, const Station& end_station);
 };
 
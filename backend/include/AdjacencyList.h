@@ -1,9 +1,17 @@
 #pragma once
 
+#include <algorithm>
 #include <array>
+#include <cstddef>
+#include <memory>
 #include <string>
+#include <string_view>
+#include <utility>
 #include <vector>
 #include <unordered_map>
+#include "TimeSlice.h"
+
+class MappedFile;
 
 struct Station {
     std::string station_name;
@@ -14,18 +22,76 @@ struct Station {
     }
 };
 
+// Edges refer to stations by ID; use AdjacencyList::GetStation to resolve them when a path is emitted
 struct Edge {
-    Station start_station;
-    Station end_station;
+    int start_id{};
+    int end_id{};
     double travel_time{};
 
     bool operator==(const Edge& other) const {
-        return start_station == other.start_station &&
-               end_station == other.end_station &&
+        return start_id == other.start_id &&
+               end_id == other.end_id &&
                travel_time == other.travel_time;
     }
 };
 
+// Frozen compressed sparse row (CSR) copy of one composite key's adjacency list
+// The edges leaving station s are targets[i] / weights[i] for offsets[s] <= i < offsets[s + 1],
+// in the same order as the matching vector in the adjacency list
+// One read-only array of a CsrGraph, read like a const std::vector. It either owns its values or views values
+// owned elsewhere, such as a section of a mapped snapshot, which must outlive it
+template <typename T>
+class CsrArray {
+    private:
+
+        std::vector<T> owned_;
+        const T* data_ = nullptr;
+        std::size_t size_ = 0;
+
+    public:
+
+        CsrArray() = default;
+        explicit CsrArray(std::vector<T> values)
+            : owned_(std::move(values)), data_(owned_.data()), size_(owned_.size()) {}
+        CsrArray(const T* data, std::size_t size) : data_(data), size_(size) {}
+
+        // A copy of an owning array owns a copy of the values; a copy of a view is another view
+        CsrArray(const CsrArray& other)
+            : owned_(other.owned_), data_(other.owned_.empty() ? other.data_ : owned_.data()), size_(other.size_) {}
+        CsrArray(CsrArray&& other) noexcept
+            : owned_(std::move(other.owned_)), data_(other.data_), size_(other.size_) {
+            other.data_ = nullptr;
+            other.size_ = 0;
+        }
+        CsrArray& operator=(CsrArray other) noexcept {
+            owned_.swap(other.owned_);
+            std::swap(data_, other.data_);
+            std::swap(size_, other.size_);
+            return *this;
+        }
+
+        const T& operator[](std::size_t index) const { return data_[index]; }
+        const T* data() const { return data_; }
+        const T* begin() const { return data_; }
+        const T* end() const { return data_ + size_; }
+        std::size_t size() const { return size_; }
+        bool empty() const { return size_ == 0; }
+
+        bool operator==(const CsrArray& other) const {
+            return size_ == other.size_ && std::equal(begin(), end(), other.begin());
+        }
+};
+
+struct CsrGraph {
+    CsrArray<int> offsets;     // station_count + 1 entries, indexed by station ID
+    CsrArray<int> targets;     // end station ID of every edge
+    CsrArray<double> weights;  // travel time of every edge
+
+    int StationCount() const { return static_cast<int>(offsets.size()) - 1; }
+    // Quickest weight of the edges from one station to another, infinity if there is none
+    double EdgeWeight(int from_id, int to_id) const;
+};
+
 struct ArrayHash {
     std::size_t operator()(const std::array<std::string, 3>& arr) const {
         const auto month = std::hash<std::string>{}(arr[0]);
@@ -48,11 +114,19 @@ struct StationHash {
     }
 };
 
+// Selects how LoadFromCSV reads and tokenizes the file
+enum class CsvLoadMode {
+    Stream,    // std::getline and std::stringstream per row
+    Mapped,    // mmap the file and tokenize fields in place as string_views
+    Parallel,  // Mapped, but split into newline-aligned chunks parsed on separate threads
+};
+
 class AdjacencyList {
     private:
 
         // Bidirectionally map station IDs to stations
-        std::unordered_map<int, Station> id_to_station_;
+        // IDs are dense, so the ID to station direction is a plain vector
+        std::vector<Station> id_to_station_;
         std::unordered_map<Station, int, StationHash> station_to_id_;
 
         // Convert between station name and station for frontend
@@ -61,6 +135,14 @@ class AdjacencyList {
         // Store multiple different adjacency lists mapped by a composite key containing month, day, and time of day
         std::unordered_map<std::array<std::string, 3>, std::unordered_map<int, std::vector<Edge>>, ArrayHash> adj_list_;
 
+        // Read-only CSR layout of every adjacency list, rebuilt whenever the graph is loaded
+        // Indexed by TimeSlice::Index(); slices without data have empty offsets
+        std::vector<CsrGraph> slice_graphs_;
+        // Same graphs with every edge reversed (targets are start stations), for backward searches
+        std::vector<CsrGraph> reverse_slice_graphs_;
+        // After LoadFromSnapshot the CSR graphs view this mapping instead of owning their arrays
+        std::shared_ptr<const MappedFile> snapshot_;
+
         int station_count_;
 
         // Helper function for AddEdge
@@ -71,21 +153,66 @@ class AdjacencyList {
         void AddEdge(const std::array<std::string, 3>& composite_key,
             const Station& start_station, const Station& end_station, double travel_time);
 
+        // Chunk of parsed rows with chunk-local IDs, defined in AdjacencyList.cpp
+        struct PartialGraph;
+
+        // LoadFromCSV implementations for each CsvLoadMode
+        void LoadFromStreamCSV(const std::string& file_path);
+        void LoadFromMappedCSV(const std::string& file_path, unsigned int thread_count);
+        // Helper functions for LoadFromMappedCSV
+        // Parses the rows in text into partial without touching any shared state
+        static void ParseChunk(std::string_view text, PartialGraph& partial);
+        // Interns the partial graph's stations and appends its edges in row order
+        void MergePartialGraph(const PartialGraph& partial);
+
+        // Rebuilds slice_graphs_ from adj_list_ once loading has finished
+        void BuildCsrGraphs();
+        // Rebuilds reverse_slice_graphs_ from slice_graphs_
+        void BuildReverseCsrGraphs();
+
     public:
 
 
 
-        explicit AdjacencyList() : station_count_(0) {};
+        explicit AdjacencyList()
+            : slice_graphs_(TimeSlice::kCount), reverse_slice_graphs_(TimeSlice::kCount), station_count_(0) {};
 
         // Populates adjacency_list using the given file path
-        void LoadFromCSV(const std::string& file_path);
+        // thread_count is only used by CsvLoadMode::Parallel, where 0 means one thread per hardware core
+        void LoadFromCSV(const std::string& file_path, CsvLoadMode mode = CsvLoadMode::Stream,
+            unsigned int thread_count = 0);
 
         const Station* GetStation(int station_id) const;
         const Station* GetStation(const std::string &name) const;
         const int GetStationId(const Station& station) const;
+        // Stations of a path given as station IDs, skipping any station whose name is already on it, the way every
+        // engine reports its paths
+        std::vector<Station> GetStationPath(const std::vector<int>& station_ids) const;
         const int GetStationCount() const { return station_count_; }
 
         // Accessor function to allow AStar and Dijkstra access to the adjacency list.
+        // A snapshot only holds the CSR graphs, so after LoadFromSnapshot the list is rebuilt from them on first use
         std::unordered_map<int, std::vector<Edge>>* GetAdjacencyList(const std::array<std::string, 3>& composite_key);
+        // Read-only CSR layout of the same adjacency list, or nullptr if there is no data for the composite key
+        const CsrGraph* GetCsrGraph(const std::array<std::string, 3>& composite_key) const;
+        // Same as above without any hashing: the slice indexes a flat array
+        const CsrGraph* GetCsrGraph(TimeSlice slice) const;
+        // The slice's graph with every edge reversed: the entries of a station are the edges arriving at it
+        // and their targets are the stations the edges leave from. nullptr if there is no data for the slice
+        const CsrGraph* GetReverseCsrGraph(TimeSlice slice) const;
+        // Every time slice that has data, in index order
+        std::vector<TimeSlice> GetTimeSlices() const;
+
+        // Writes the fully built graph to a versioned binary snapshot (see GraphSnapshot.h), stamped with the size and
+        // modification time of source_path, the CSV it was loaded from, if that is given. Returns false on failure
+        bool SaveSnapshot(const std::string& file_path, const std::string& source_path = "") const;
+        // Replaces the graph with the contents of a snapshot written by SaveSnapshot. The file stays mapped and the
+        // CSR graphs are read from it in place. With a source_path, a snapshot stamped for another version of that
+        // CSV is rejected, so the caller parses the CSV again
+        // Returns false, leaving the graph unchanged, if the file is missing, from another version, or fails its checksum
+        bool LoadFromSnapshot(const std::string& file_path, const std::string& source_path = "");
+
+        // Two lists are equal if they assign the same IDs to the same stations and hold the same edges in the same order
+        bool operator==(const AdjacencyList& other) const;
 
 };
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <utility>
+#include <vector>
+#include "AdjacencyList.h"
+#include "PriorityQueue.h"
+#include "SearchScratch.h"
+
+// Alternative routes engine: Yen's k quickest loopless paths.
+// Each new route is the quickest deviation from an earlier one. For a station on that route (the spur station)
+// the route up to it is kept, its earlier stations are banned, so are the edges that routes found so far with the
+// same beginning take out of it, and the quickest way on from the spur station is searched. Spur stations before
+// the point where a route left its parent only repeat candidates already found (Lawler), so they are skipped.
+// One backward search from the end station per query is shared by every spur: its times to the end are exact
+// A* lower bounds whatever is banned, and when its tree path from a spur station avoids the bans, that path is
+// the answer without searching at all.
+class AlternativeRoutes {
+    private:
+
+        // Stations a spur search may not visit, cleared in O(1) by moving to a new generation
+        struct BannedStations {
+            std::vector<std::uint32_t> stamps;
+            std::uint32_t generation = 0;
+
+            void Reset(int station_count) {
+                if (static_cast<int>(stamps.size()) < station_count) {
+                    stamps.resize(station_count, 0);
+                }
+                if (++generation == 0) {
+                    std::fill(stamps.begin(), stamps.end(), 0);
+                    generation = 1;
+                }
+            }
+            void Ban(int station_id) { stamps[station_id] = generation; }
+            bool IsBanned(int station_id) const { return stamps[station_id] == generation; }
+        };
+
+        const AdjacencyList* adj_list_;
+        QueueType queue_type_;
+
+        // Helper function for GetQuickestPaths
+        // Appends the quickest way from spur_id to end_id (without spur_id) that avoids the banned stations and the
+        // edges from spur_id to any station in banned_next. to_end holds the backward search from end_id.
+        // Returns false if there is no such way
+        bool AppendSpurPath(const CsrGraph& graph, const SearchState& to_end, int spur_id, int end_id,
+                            const BannedStations& banned, const std::vector<int>& banned_next, std::vector<int>& path,
+                            SearchStats& stats) const;
+
+    public:
+
+        explicit AlternativeRoutes(const AdjacencyList* adj_list, QueueType queue_type = QueueType::QuaternaryHeap)
+            : adj_list_(adj_list), queue_type_(queue_type) {}
+
+        // Up to k quickest loopless routes from start_id to end_id on the slice's graph, quickest first, as
+        // (time, stations) like Dijkstra::GetQuickestPath. Fewer when the network has no more; none for a bad slice
+        // or station, or when the end cannot be reached. Thread safe like the other engines
+        std::vector<std::pair<double, std::vector<Station>>> GetQuickestPaths(TimeSlice slice, int start_id,
+                                                                              int end_id, int k,
+                                                                              SearchStats* stats = nullptr) const;
+
+};
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <vector>
+#include "AdjacencyList.h"
+#include "PriorityQueue.h"
+#include "SearchScratch.h"
+#include "SearchTrace.h"
+
+class BidirectionalDijkstra {
+
+  private:
+
+    AdjacencyList* adj_lists_;
+    // Queue used by both frontiers. Each frontier borrows its own slot of the calling thread's SearchScratch
+    QueueType queue_type_;
+
+    // Helper function for GetQuickestPath
+    // Joins the forward path to from_id, the meeting edge, and the backward path from to_id to the end station
+    std::pair<double, std::vector<Station>> GetPath(const CsrGraph& graph, const SearchState& forward,
+                                                    const SearchState& backward, int from_id, int to_id) const;
+    // Helper function for GetQuickestPath
+    // The search itself, reporting the steps of both frontiers to trace (NullTrace compiles the reporting away)
+    template <typename Trace>
+    std::pair<double, std::vector<Station>> Search(TimeSlice slice, int start_id, int end_id, SearchStats* stats,
+                                                   Trace& trace) const;
+
+  public:
+
+    explicit BidirectionalDijkstra(AdjacencyList* adj_lists, QueueType queue_type = QueueType::QuaternaryHeap)
+      : adj_lists_(adj_lists), queue_type_(queue_type) {}
+
+    // Runs Dijkstra forward from the start on the slice's graph and backward from the end on its reverse graph,
+    // alternating between them. The best path seen through any edge joining the two frontiers is final once the
+    // last keys popped on both sides add up to at least its time.
+    // Same contract as Dijkstra::GetQuickestPath, and thread safe in the same way
+    std::pair<double, std::vector<Station>> GetQuickestPath(TimeSlice slice, int start_id, int end_id,
+                                                            SearchStats* stats = nullptr) const;
+    // Same search, recording both frontiers' settle order, relaxations and queue operations in trace
+    std::pair<double, std::vector<Station>> GetQuickestPath(TimeSlice slice, int start_id, int end_id,
+                                                            RecordingTrace& trace, SearchStats* stats = nullptr) const;
+
+};
@@ -0,0 +1,112 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <thread>
+#include <utility>
+#include <vector>
+#include "AdjacencyList.h"
+#include "PriorityQueue.h"
+#include "SearchScratch.h"
+
+// Summary of a hierarchy build, for the startup log
+struct ContractionHierarchyReport {
+    int slices = 0;
+    int stations = 0;
+    std::size_t original_arcs = 0;  // distinct station pairs with an edge, summed over slices
+    std::size_t shortcuts = 0;
+    double build_seconds = 0;
+};
+
+// Contraction Hierarchies engine, one hierarchy per time slice.
+// Preprocessing contracts stations one at a time in order of importance (edge difference plus contracted
+// neighbors, updated lazily), adding a shortcut between two neighbors only when a bounded witness search
+// finds no path at least as quick that avoids the contracted station. A query is then a bidirectional
+// Dijkstra that only climbs towards more important stations, with shortcuts unpacked back into stations.
+class ContractionHierarchy {
+    private:
+
+        // Edge of a hierarchy. middle is the contracted station a shortcut bypasses, -1 for original edges
+        struct Arc {
+            int target;
+            double weight;
+            int middle;
+        };
+
+        // Arcs grouped by station in CSR form. up holds each station's edges to more important stations;
+        // down holds the edges arriving at each station from more important stations, keyed by the arrival
+        // station with the departure station as target, so the backward search also only climbs
+        struct Hierarchy {
+            std::vector<int> rank;
+            std::vector<int> up_offsets;
+            std::vector<Arc> up_arcs;
+            std::vector<int> down_offsets;
+            std::vector<Arc> down_arcs;
+            std::size_t original_arcs = 0;
+            std::size_t shortcuts = 0;
+
+            bool IsBuilt() const { return !rank.empty(); }
+        };
+
+        const AdjacencyList* adj_list_;
+        QueueType queue_type_;
+        std::vector<Hierarchy> hierarchies_;  // indexed by TimeSlice::Index()
+        ContractionHierarchyReport report_;
+        std::atomic<bool> ready_;
+        std::thread builder_;
+
+        // Helper function for Build
+        // Orders and contracts every station of one slice's graph
+        static Hierarchy Contract(const CsrGraph& graph);
+        // Helper function for GetQuickestPath
+        // Appends the stations an arc stands for (excluding from_id) and adds up their original edge weights
+        void UnpackArc(const Hierarchy& hierarchy, int from_id, const Arc& arc, std::vector<int>& station_path,
+                       double& total_time) const;
+        // Helper function for GetTimeMatrix
+        // Runs a search from start_id that only follows the given arcs to the end, recording every settled
+        // station with its time
+        void UpwardSearch(const std::vector<int>& offsets, const std::vector<Arc>& arcs, int start_id,
+                          std::vector<std::pair<int, double>>& settled, SearchStats& stats) const;
+        static const Arc* FindArc(const std::vector<int>& offsets, const std::vector<Arc>& arcs, int station_id,
+                                  int target);
+
+    public:
+
+        explicit ContractionHierarchy(const AdjacencyList* adj_list, QueueType queue_type = QueueType::QuaternaryHeap);
+        ~ContractionHierarchy();
+
+        ContractionHierarchy(const ContractionHierarchy&) = delete;
+        ContractionHierarchy& operator=(const ContractionHierarchy&) = delete;
+
+        // Builds the hierarchies of the given slices (every slice with data when empty) on thread_count threads
+        // (0 = one per hardware thread). Call once, before any query
+        void Build(unsigned int thread_count = 0, const std::vector<TimeSlice>& slices = {});
+        // Runs Build on a background thread; IsReady() turns true once it finishes
+        void StartBackgroundBuild(unsigned int thread_count = 0);
+
+        bool IsReady() const { return ready_.load(std::memory_order_acquire); }
+        bool HasSlice(TimeSlice slice) const;
+
+        // Same contract as Dijkstra::GetQuickestPath; thread safe once IsReady()
+        // The time is the sum of the original edge weights along the unpacked path
+        std::pair<double, std::vector<Station>> GetQuickestPath(TimeSlice slice, int start_id, int end_id,
+                                                                SearchStats* stats = nullptr) const;
+
+        // Many-to-many times with buckets: an upward search from each target leaves (target, time) in the bucket
+        // of every station it settles, then an upward search from each source adds its time to each station it
+        // settles to the entries of that station's bucket. Every pair meets at its path's most important station,
+        // so each source and target costs one small search. Searches run on up to thread_count threads
+        // (0 = one per hardware thread). Fills times row-major, sources by targets: -1 for a bad station ID and
+        // infinity where there is no path. The times are sums of shortcut weights, so they may differ from
+        // GetQuickestPath in the last bits. Returns false if the slice has no hierarchy
+        bool GetTimeMatrix(TimeSlice slice, const std::vector<int>& sources, const std::vector<int>& targets,
+                           std::vector<double>& times, unsigned int thread_count = 1,
+                           SearchStats* stats = nullptr) const;
+
+        // Valid once IsReady()
+        const ContractionHierarchyReport& GetReport() const { return report_; }
+        static void PrintReport(std::ostream& out, const ContractionHierarchyReport& report);
+
+};
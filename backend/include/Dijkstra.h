@@ -1,48 +1,95 @@
 #pragma once
 
-#include <queue>
+#include <limits>
+#include <vector>
 #include "AdjacencyList.h"
+#include "PriorityQueue.h"
+#include "SearchScratch.h"
+#include "SearchTrace.h"
 
 class Dijkstra {
 
   private:
 
-    struct Node {
-      int station_id;
-      double travel_time;
-
-      Node(int id, double time) : station_id(id), travel_time(time) {}
-
-      bool operator>(const Node& other) const {
-        return travel_time > other.travel_time;
-      }
-
-    };
-
     std::array<std::string, 3> composite_key_;
+    // composite_key_ parsed once when it is set, so searches never hash strings
+    TimeSlice slice_;
     AdjacencyList* adj_lists_;
+    // Queue used for every search. The queue itself comes from the calling thread's SearchScratch
+    QueueType queue_type_;
 
-    // Returns the adjacency list keyed to the composite_key_
-    std::unordered_map<int, std::vector<Edge>>* GetAdjacencyList() const;
     // Helper function for GetQuickestPath
     // Relaxes the edge between two stations
-    static void relaxEdge(int from_id, int to_id, double edge_weight,
-                    std::unordered_map<int, double>& times,
-                    std::unordered_map<int, int>& predecessors,
-                    std::priority_queue<Node, std::vector<Node>, std::greater<>>& pq);
+    template <typename Trace>
+    static void relaxEdge(int from_id, int to_id, double edge_weight, SearchScratch& scratch, Trace& trace);
+    // Bound for searches that run until every reachable station is settled
+    static constexpr double kUnbounded = std::numeric_limits<double>::infinity();
+
+    // Helper function for SearchFrom, SearchToTargets and GetReachableStations
+    // Dijkstra on graph from start_id into scratch, stopping after settling a station for which stop returns true.
+    // Stations more than bound from start_id are never queued
+    template <typename Stop>
+    static void SettleFrom(const CsrGraph& graph, int start_id, double bound, SearchScratch& scratch,
+                           SearchStats& stats, Stop&& stop);
+    // Helper function for GetQuickestPath
+    // The search itself, reporting each step to trace (NullTrace compiles the reporting away)
+    template <typename Trace>
+    std::pair<double, std::vector<Station>> Search(TimeSlice slice, int start_id, int end_id, SearchStats* stats,
+                                                   Trace& trace) const;
     // Helper function for GetQuickestPath
-    // Uses predecessors list to get the quickest path found by Dijkstra algorithm
-    std::vector<Station> GetPath(std::unordered_map<int, int> predecessors, int start_id, int end_id) const;
+    // Uses the predecessors in state to get the quickest path found by Dijkstra algorithm
+    std::vector<Station> GetPath(const SearchState& state, int start_id, int end_id) const;
 
   public:
 
-    explicit Dijkstra(AdjacencyList* adj_lists)
-      : composite_key_({}), adj_lists_(adj_lists) {}
+    explicit Dijkstra(AdjacencyList* adj_lists, QueueType queue_type = QueueType::QuaternaryHeap)
+      : composite_key_({}), adj_lists_(adj_lists), queue_type_(queue_type) {}
 
+    // Runs the Dijkstra Search algorithm on the slice's graph
+    // Thread safe: nothing in the engine changes, and the search state belongs to the calling thread
+    // Fills in stats for this search if it is not null
+    std::pair<double, std::vector<Station>> GetQuickestPath(TimeSlice slice, int start_id, int end_id,
+                                                            SearchStats* stats = nullptr) const;
+    // Same search, recording the settle order, relaxations and queue operations in trace
+    std::pair<double, std::vector<Station>> GetQuickestPath(TimeSlice slice, int start_id, int end_id,
+                                                            RecordingTrace& trace, SearchStats* stats = nullptr) const;
+    // One-to-many search on graph from start_id, which must be a station, that stops once every station in
+    // end_ids is settled; entries that are not stations are ignored. The times and predecessors of the targets
+    // are left in scratch.state. Shared by GetQuickestPaths, the distance matrices and anything else that needs
+    // several targets from one start
+    static void SearchToTargets(const CsrGraph& graph, int start_id, const std::vector<int>& end_ids,
+                                SearchScratch& scratch, SearchStats& stats);
+    // One-to-all search on graph from start_id, which must be a station; every reachable station's time and
+    // predecessor are left in scratch.state. On a reverse graph these are times to start_id, and predecessors
+    // are the next station on the way there
+    static void SearchFrom(const CsrGraph& graph, int start_id, SearchScratch& scratch, SearchStats& stats);
+    // Same search, also appending every reachable station to settled in the order it was settled, so by
+    // increasing time with start_id first
+    static void SearchFrom(const CsrGraph& graph, int start_id, SearchScratch& scratch, SearchStats& stats,
+                           std::vector<int>& settled);
+    // One-to-many: a single search from start_id that stops once every station in end_ids is settled
+    // Returns one (time, path) per entry of end_ids, in the same order, as GetQuickestPath would for that pair
+    std::vector<std::pair<double, std::vector<Station>>> GetQuickestPaths(TimeSlice slice, int start_id,
+                                                                          const std::vector<int>& end_ids,
+                                                                          SearchStats* stats = nullptr) const;
+    // Bounded one-to-all: every station reachable from start_id within time_budget minutes, as
+    // (station ID, time) in the order they were settled, so by increasing time with the start first.
+    // reachable is cleared and refilled, so a caller that keeps it (and the calling thread's search state)
+    // between queries does not allocate once both have grown. Returns false for a bad slice or station
+    bool GetReachableStations(TimeSlice slice, int start_id, double time_budget,
+                              std::vector<std::pair<int, double>>& reachable, SearchStats* stats = nullptr) const;
     // Runs the Dijkstra Search algorithm using the stored adjacency list keyed to the composite_key_
+    // Not safe to share between threads that set different composite keys; use the slice overload instead
     std::pair<double, std::vector<Station>> GetQuickestPath(const Station& start_station, const Station& end_station);
 
-    void SetCompositeKey(const std::array<std::string, 3>& composite_key) {composite_key_ = composite_key;}
+    void SetCompositeKey(const std::array<std::string, 3>& composite_key) {
+      composite_key_ = composite_key;
+      slice_ = TimeSlice::FromCompositeKey(composite_key);
+    }
+    void SetTimeSlice(TimeSlice slice) {
+      composite_key_ = slice.ToCompositeKey();
+      slice_ = slice;
+    }
     std::array<std::string, 3> GetCompositeKey() const { return composite_key_; }
 
 };
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <vector>
+#include "AdjacencyList.h"
+#include "ContractionHierarchy.h"
+#include "PriorityQueue.h"
+#include "SearchScratch.h"
+
+enum class MatrixAlgorithm {
+    OneToAll,  // one Dijkstra search per source, stopped once every target is settled
+    Buckets,   // bucket-based many-to-many over the slice's contraction hierarchy
+};
+
+// Travel time matrices between a list of sources and a list of targets on one time slice.
+// Pairwise queries repeat the same search from a source once per target and stop at that target; here each
+// source is searched once for all targets, and the sources are spread over threads. With a contraction
+// hierarchy, Buckets replaces the per-source searches with one small upward search per source and per target.
+class DistanceMatrix {
+    private:
+
+        const AdjacencyList* adj_list_;
+        const ContractionHierarchy* hierarchy_;  // optional, needed for Buckets
+        QueueType queue_type_;
+
+    public:
+
+        explicit DistanceMatrix(const AdjacencyList* adj_list, const ContractionHierarchy* hierarchy = nullptr,
+                                QueueType queue_type = QueueType::QuaternaryHeap)
+            : adj_list_(adj_list), hierarchy_(hierarchy), queue_type_(queue_type) {}
+
+        // Whether Compute can use Buckets for the slice
+        bool HasBuckets(TimeSlice slice) const { return hierarchy_ != nullptr && hierarchy_->HasSlice(slice); }
+
+        // Fills times row-major: times[i * targets.size() + j] is the quickest time from sources[i] to targets[j],
+        // infinity where there is no path and -1 where either ID is not a station. Searches run on up to
+        // thread_count threads (0 = one per hardware thread); thread safe, like the engines.
+        // Returns false if the slice has no graph, or for Buckets if it has no hierarchy yet
+        bool Compute(TimeSlice slice, const std::vector<int>& sources, const std::vector<int>& targets,
+                     MatrixAlgorithm algorithm, std::vector<double>& times, unsigned int thread_count = 0,
+                     SearchStats* stats = nullptr) const;
+
+};
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// On-disk layout of the binary graph snapshot written by AdjacencyList::SaveSnapshot.
+//
+// The file is a fixed header followed by a payload of 8-byte aligned sections:
+//   StationRecord[station_count]                 coordinates and name of every station, indexed by station ID
+//   KeyRecord[key_count]                         composite key strings and where its edges start
+//   int32_t[key_count * (station_count + 1)]     CSR offsets per composite key, relative to the key's first edge
+//   int32_t[edge_count]                          CSR edge targets (end station IDs)
+//   double[edge_count]                           CSR travel times
+//   int32_t[key_count * (station_count + 1)]     reverse CSR offsets, laid out like the forward ones
+//   int32_t[edge_count]                          reverse CSR edge targets (start station IDs)
+//   double[edge_count]                           reverse CSR travel times
+//   char[string_bytes]                           station names and composite key strings
+//
+// The CSR sections hold exactly what CsrGraph holds, so a loaded snapshot serves its graphs from the mapping.
+// Values are stored in host byte order; the endian marker rejects files written on a different architecture.
+namespace graph_snapshot {
+
+constexpr char kMagic[8] = {'S', 'U', 'B', 'W', 'A', 'Y', 'G', 'S'};
+constexpr std::uint32_t kVersion = 2;
+constexpr std::uint32_t kEndianMarker = 0x01020304;
+
+struct Header {
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t endian_marker;
+    std::uint32_t station_count;
+    std::uint32_t key_count;
+    std::uint64_t edge_count;
+    std::uint64_t string_bytes;
+    std::uint64_t payload_size;
+    // FNV-1a hash of the whole payload
+    std::uint64_t payload_checksum;
+    // The CSV the graph was loaded from, zero if unknown
+    std::uint64_t source_size;
+    std::uint64_t source_modified;
+};
+
+struct StationRecord {
+    double latitude;
+    double longitude;
+    std::uint32_t name_offset;
+    std::uint32_t name_length;
+};
+
+struct KeyRecord {
+    std::uint32_t field_offsets[3];
+    std::uint32_t field_lengths[3];
+    std::uint64_t first_edge;
+};
+
+static_assert(sizeof(Header) == 72, "snapshot header layout changed");
+static_assert(sizeof(StationRecord) == 24, "snapshot station layout changed");
+static_assert(sizeof(KeyRecord) == 32, "snapshot key layout changed");
+
+static_assert(sizeof(int) == sizeof(std::int32_t), "CSR sections are read as int arrays");
+
+// 64-bit FNV-1a hash used for the payload checksum
+std::uint64_t Checksum(const char* data, std::size_t size);
+
+// Size and modification time of a file, for telling whether a snapshot was built from its current contents.
+// Returns false if the file cannot be read
+bool SourceStamp(const std::string& file_path, std::uint64_t& size, std::uint64_t& modified);
+
+}  // namespace graph_snapshot
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+#include "AdjacencyList.h"
+
+// Landmark distances for ALT (A*, Landmarks, Triangle inequality) lower bounds, one set per time slice.
+// For a landmark L and any stations v, t the triangle inequality gives
+//     time(v, t) >= time(L, t) - time(L, v)   and   time(v, t) >= time(v, L) - time(t, L)
+// so the best of these over all landmarks is an admissible and consistent A* heuristic for that slice.
+class LandmarkTable {
+    public:
+
+        struct SliceLandmarks {
+            std::vector<int> landmarks;
+            // Row-major station_count x landmark_count: from_landmark[v * k + i] is time(landmark i, v) and
+            // to_landmark[v * k + i] is time(v, landmark i); infinity where there is no path
+            std::vector<double> from_landmark;
+            std::vector<double> to_landmark;
+
+            // Lower bound on the quickest time from from_id to to_id
+            double LowerBound(int from_id, int to_id) const;
+        };
+
+    private:
+
+        const AdjacencyList* adj_list_;
+        int landmark_count_;
+        std::vector<SliceLandmarks> slices_;  // indexed by TimeSlice::Index()
+
+        // Helper function for Build
+        // Picks landmarks far apart on one slice and records their times to and from every station
+        static SliceLandmarks BuildSlice(const CsrGraph& graph, const CsrGraph& reverse_graph, int landmark_count);
+
+    public:
+
+        explicit LandmarkTable(const AdjacencyList* adj_list) : adj_list_(adj_list), landmark_count_(0) {}
+
+        // Selects landmark_count landmarks per slice with data and runs two one-to-all searches for each,
+        // spread over thread_count threads (0 = one per hardware thread). Call once, before any query
+        void Build(int landmark_count = 8, unsigned int thread_count = 0);
+
+        // Landmarks of the slice, or nullptr if it has none
+        const SliceLandmarks* GetSlice(TimeSlice slice) const;
+        int GetLandmarkCount() const { return landmark_count_; }
+        std::size_t MemoryBytes() const;
+
+};
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+// Concurrent HDR-style (log-linear) histogram of non-negative integer values, such as latencies in microseconds.
+// Values below 256 get a bucket each; above that every power of two range is split into 128 equal buckets,
+// so any recorded value is known to within 1/128 (under 0.8%) while the whole range to kMaxValue takes a
+// fixed ~35 KB. Record is a few relaxed atomic adds, so any number of threads can share one histogram;
+// readers see a consistent enough picture for percentiles and counters without stopping the writers.
+class LatencyHistogram {
+    private:
+
+        static constexpr int kSubBucketBits = 8;
+        static constexpr std::uint64_t kSubBucketCount = std::uint64_t(1) << kSubBucketBits;  // 256
+        static constexpr std::uint64_t kSubBucketHalf = kSubBucketCount / 2;                 // 128
+        static constexpr int kMaxMagnitude = 40;
+
+    public:
+
+        // Larger values are recorded as kMaxValue: about 12.7 days in microseconds
+        static constexpr std::uint64_t kMaxValue = (std::uint64_t(1) << kMaxMagnitude) - 1;
+        static constexpr std::size_t kBucketCount =
+            (kMaxMagnitude - kSubBucketBits + 1) * kSubBucketHalf + kSubBucketHalf;
+
+    private:
+
+        std::array<std::atomic<std::uint64_t>, kBucketCount> buckets_;
+        std::atomic<std::uint64_t> count_;
+        std::atomic<std::uint64_t> sum_;
+        std::atomic<std::uint64_t> min_;
+        std::atomic<std::uint64_t> max_;
+
+        static std::size_t BucketIndex(std::uint64_t value);
+        // Smallest and largest values that land in a bucket
+        static std::uint64_t BucketLowest(std::size_t index);
+        static std::uint64_t BucketHighest(std::size_t index);
+
+    public:
+
+        LatencyHistogram();
+
+        LatencyHistogram(const LatencyHistogram&) = delete;
+        LatencyHistogram& operator=(const LatencyHistogram&) = delete;
+
+        void Record(std::uint64_t value);
+        // Adds every value recorded in other to this histogram
+        void Merge(const LatencyHistogram& other);
+        void Reset();
+
+        std::uint64_t GetCount() const { return count_.load(std::memory_order_relaxed); }
+        std::uint64_t GetSum() const { return sum_.load(std::memory_order_relaxed); }
+        // 0 when nothing has been recorded
+        std::uint64_t GetMin() const;
+        std::uint64_t GetMax() const { return max_.load(std::memory_order_relaxed); }
+        double GetMean() const;
+
+        // Highest value equivalent to the one at the percentile (0 to 100) of recorded values, capped at GetMax()
+        std::uint64_t ValueAtPercentile(double percentile) const;
+        // Number of recorded values that are at most value, up to the bucket resolution
+        std::uint64_t CountAtOrBelow(std::uint64_t value) const;
+
+};
@@ -0,0 +1,138 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <thread>
+
+enum class LogLevel : int { Debug, Info, Warning, Error, Off };
+
+const char* LogLevelName(LogLevel level);
+// Accepts debug, info, warning, error and off
+bool ParseLogLevel(std::string_view text, LogLevel& level);
+
+// Lowest level compiled in. Statements below it are removed by the compiler, arguments and all.
+// Release builds drop debug logging unless the build overrides this, e.g. -DSUBWAY_LOG_MIN_LEVEL=0
+#ifndef SUBWAY_LOG_MIN_LEVEL
+#ifdef NDEBUG
+#define SUBWAY_LOG_MIN_LEVEL 1
+#else
+#define SUBWAY_LOG_MIN_LEVEL 0
+#endif
+#endif
+
+// Asynchronous logger. Callers format a line and put it in a fixed-size ring buffer, which costs a clock
+// read, a compare-and-swap and a string move, and never a system call. A background thread writes the lines in
+// batches and flushes once per batch, checking for new lines every 50 ms once the buffer is empty, so request
+// threads never wait on the output stream. A full buffer drops the line and counts it rather than blocking the caller.
+class Logger {
+    private:
+
+        static constexpr std::size_t kCapacity = 8192;  // power of two
+
+        struct Record {
+            std::atomic<std::size_t> sequence;
+            LogLevel level;
+            std::chrono::system_clock::time_point time;
+            std::string text;
+        };
+
+        std::unique_ptr<std::array<Record, kCapacity>> ring_;
+        std::atomic<std::size_t> enqueue_position_;
+        std::size_t dequeue_position_;  // writer thread only
+
+        std::atomic<int> level_;
+        std::atomic<std::uint64_t> dropped_;
+        std::atomic<std::uint64_t> written_;
+        std::atomic<std::FILE*> output_;
+
+        std::mutex wake_mutex_;
+        std::condition_variable wake_;
+        std::atomic<bool> stopping_;
+        std::thread writer_;
+
+        Logger();
+
+        // Helper function for the writer thread
+        // Writes every queued line, returns how many it wrote
+        std::size_t Drain();
+        void WriterLoop();
+
+    public:
+
+        ~Logger();
+
+        Logger(const Logger&) = delete;
+        Logger& operator=(const Logger&) = delete;
+
+        static Logger& Instance();
+
+        // Runtime filter on top of SUBWAY_LOG_MIN_LEVEL
+        void SetLevel(LogLevel level) { level_.store(static_cast<int>(level), std::memory_order_relaxed); }
+        LogLevel GetLevel() const { return static_cast<LogLevel>(level_.load(std::memory_order_relaxed)); }
+        bool IsEnabled(LogLevel level) const {
+            return static_cast<int>(level) >= level_.load(std::memory_order_relaxed);
+        }
+
+        // Where the writer thread puts lines; stdout unless changed
+        void SetOutput(std::FILE* output);
+
+        // Queues a line, without its trailing newline if it has one; returns false if the buffer was full and
+        // the line was dropped
+        bool Log(LogLevel level, std::string text);
+
+        // Blocks until every line queued before the call has been written
+        void Flush();
+
+        std::uint64_t DroppedCount() const { return dropped_.load(std::memory_order_relaxed); }
+        std::uint64_t WrittenCount() const { return written_.load(std::memory_order_relaxed); }
+
+};
+
+// Collects one line with operator<< and queues it when destroyed
+class LogLine {
+    private:
+
+        LogLevel level_;
+        std::ostringstream stream_;
+
+    public:
+
+        explicit LogLine(LogLevel level) : level_(level) {}
+        ~LogLine() { Logger::Instance().Log(level_, stream_.str()); }
+
+        template <typename T>
+        LogLine& operator<<(const T& value) {
+            stream_ << value;
+            return *this;
+        }
+
+};
+
+// True when a statement at level would be written. Constant false below SUBWAY_LOG_MIN_LEVEL, so code
+// guarded by it, such as loops that build a message, is compiled out along with the statement
+#define SUBWAY_LOG_ENABLED(level) \
+    (static_cast<int>(level) >= SUBWAY_LOG_MIN_LEVEL && Logger::Instance().IsEnabled(level))
+
+// Usage: LOG_INFO("Loaded " << count << " stations"); the message is only formatted if the level is enabled.
+// Variadic so messages may contain commas, as in template arguments
+#define SUBWAY_LOG(level, ...)             \
+    do {                                   \
+        if (SUBWAY_LOG_ENABLED(level)) {   \
+            LogLine(level) << __VA_ARGS__; \
+        }                                  \
+    } while (false)
+
+#define LOG_DEBUG(...) SUBWAY_LOG(LogLevel::Debug, __VA_ARGS__)
+#define LOG_INFO(...) SUBWAY_LOG(LogLevel::Info, __VA_ARGS__)
+#define LOG_WARNING(...) SUBWAY_LOG(LogLevel::Warning, __VA_ARGS__)
+#define LOG_ERROR(...) SUBWAY_LOG(LogLevel::Error, __VA_ARGS__)
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+// Read-only memory mapping of an entire file.
+// The mapping lives as long as the object, so views into Data() must not outlive it.
+class MappedFile {
+    private:
+
+        const char* data_;
+        std::size_t size_;
+        bool is_open_;
+
+#ifdef _WIN32
+        void* file_handle_;
+        void* mapping_handle_;
+#else
+        int file_descriptor_;
+#endif
+
+        // Releases the mapping and any handles held by this object
+        void Close();
+
+    public:
+
+        explicit MappedFile(const std::string& file_path);
+        ~MappedFile();
+
+        MappedFile(const MappedFile&) = delete;
+        MappedFile& operator=(const MappedFile&) = delete;
+
+        bool IsOpen() const { return is_open_; }
+        const char* Data() const { return data_; }
+        std::size_t Size() const { return size_; }
+        std::string_view View() const { return {data_, size_}; }
+
+};
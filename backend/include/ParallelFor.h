@@ -0,0 +1,115 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+// Threads that live for the whole process and run the tasks handed to them, so thread_local state such as
+// search scratch is built once per thread rather than once per parallel loop. A task goes to an idle thread,
+// or to a new one when every thread is busy, so a long loop (a background build) never holds up another
+// caller's loop; the pool only grows to the most tasks ever running at once.
+class WorkerPool {
+    private:
+
+        std::mutex mutex_;
+        std::condition_variable task_ready_;
+        std::deque<std::pair<const void*, std::function<void()>>> tasks_;  // (owner, task)
+        std::vector<std::thread> threads_;
+        std::size_t idle_ = 0;
+        bool stopping_ = false;
+
+        void WorkerLoop();
+
+    public:
+
+        WorkerPool() = default;
+        // Runs the queued tasks, then joins the threads
+        ~WorkerPool();
+
+        WorkerPool(const WorkerPool&) = delete;
+        WorkerPool& operator=(const WorkerPool&) = delete;
+
+        void Submit(const void* owner, std::function<void()> task);
+        // Drops the owner's tasks that no thread has started, so they do not count as waiting work
+        void Withdraw(const void* owner);
+        std::size_t ThreadCount();
+
+        // The pool ParallelFor runs on. Never destroyed, so loops still running at exit end with the process
+        static WorkerPool& Shared();
+};
+
+// Calls body(i) for every i in [0, count) on up to thread_count threads (0 = one per hardware thread): the
+// calling thread and threads of the shared WorkerPool, which keep their thread_local state between calls.
+// Indices are handed out one at a time, so uneven work items still balance across threads.
+// The first exception thrown by body is rethrown on the calling thread after all workers stop.
+template <typename Body>
+void ParallelFor(std::size_t count, unsigned int thread_count, Body&& body) {
+    if (thread_count == 0) {
+        thread_count = std::max(1u, std::thread::hardware_concurrency());
+    }
+    thread_count = static_cast<unsigned int>(std::min<std::size_t>(thread_count, count));
+    if (thread_count <= 1) {
+        for (std::size_t i = 0; i < count; ++i) {
+            body(i);
+        }
+        return;
+    }
+
+    // Shared with the pool tasks, which may only start once the loop is over; those find no index left and
+    // never touch body, so the state outlives this call but body does not need to
+    struct LoopState {
+        std::atomic<std::size_t> next_index{0};
+        std::atomic<bool> failed{false};
+        std::mutex mutex;
+        std::condition_variable all_finished;
+        std::size_t finished = 0;
+        std::exception_ptr error;
+    };
+    auto state = std::make_shared<LoopState>();
+    auto* body_ptr = &body;
+    auto run = [state, body_ptr, count]() {
+        std::size_t finished = 0;
+        for (std::size_t i = state->next_index++; i < count; i = state->next_index++, ++finished) {
+            if (state->failed) {
+                continue;  // let the other workers run out of indices
+            }
+            try {
+                (*body_ptr)(i);
+            } catch (...) {
+                std::lock_guard<std::mutex> lock(state->mutex);
+                if (!state->error) {
+                    state->error = std::current_exception();
+                }
+                state->failed = true;
+            }
+        }
+        if (finished > 0) {
+            std::lock_guard<std::mutex> lock(state->mutex);
+            state->finished += finished;
+            if (state->finished == count) {
+                state->all_finished.notify_all();
+            }
+        }
+    };
+
+    for (unsigned int worker = 1; worker < thread_count; ++worker) {
+        WorkerPool::Shared().Submit(state.get(), run);
+    }
+    run();
+    // Every index is taken once this thread runs out, so helpers that have not started have nothing left to do
+    WorkerPool::Shared().Withdraw(state.get());
+    std::unique_lock<std::mutex> lock(state->mutex);
+    state->all_finished.wait(lock, [&state, count]() { return state->finished == count; });
+    if (state->error) {
+        std::rethrow_exception(state->error);
+    }
+}
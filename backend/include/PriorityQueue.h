@@ -0,0 +1,126 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+// Priority queue implementations the search engines can be constructed with
+enum class QueueType {
+    BinaryHeap,      // std::push_heap / std::pop_heap with lazy deletion: stale entries stay queued until popped
+    QuaternaryHeap,  // indexed 4-ary heap with true decrease-key: at most one entry per station
+    RadixHeap,       // monotone radix heap over the bit patterns of non-negative keys, lazy deletion
+};
+
+struct QueueEntry {
+    int station_id;
+    double key;
+};
+
+// Operation counts accumulated since the queue was created
+struct QueueStats {
+    std::uint64_t pushes = 0;         // entries inserted
+    std::uint64_t decrease_keys = 0;  // pushes that lowered the key of a queued station instead of inserting
+    std::uint64_t pops = 0;           // entries removed, including stale ones
+    std::uint64_t max_size = 0;       // largest number of queued entries seen
+};
+
+// Min-priority queue of station IDs shared by Dijkstra and AStar
+// Push either inserts a station or lowers its key; lazy implementations may then return the same station
+// more than once, so callers must skip entries whose key is worse than the station's best known cost
+class MinQueue {
+    protected:
+
+        QueueStats stats_;
+
+        void RecordSize(std::size_t size) {
+            if (size > stats_.max_size) {
+                stats_.max_size = size;
+            }
+        }
+
+    public:
+
+        virtual ~MinQueue() = default;
+
+        // Empties the queue and prepares it for station IDs in [0, station_count). Keeps allocated capacity
+        virtual void Reset(int station_count) = 0;
+        virtual void Push(int station_id, double key) = 0;
+        // Removes and returns an entry with the smallest key. The queue must not be empty
+        virtual QueueEntry Pop() = 0;
+        virtual bool Empty() const = 0;
+
+        const QueueStats& GetStats() const { return stats_; }
+        virtual QueueType GetType() const = 0;
+
+};
+
+class BinaryHeapQueue : public MinQueue {
+    private:
+
+        std::vector<QueueEntry> heap_;
+
+    public:
+
+        void Reset(int station_count) override;
+        void Push(int station_id, double key) override;
+        QueueEntry Pop() override;
+        bool Empty() const override { return heap_.empty(); }
+        QueueType GetType() const override { return QueueType::BinaryHeap; }
+
+};
+
+class QuaternaryHeapQueue : public MinQueue {
+    private:
+
+        std::vector<QueueEntry> heap_;
+        // Index of each station in heap_, or -1 if it is not queued
+        std::vector<int> positions_;
+
+        void SiftUp(std::size_t index);
+        void SiftDown(std::size_t index);
+        void Place(std::size_t index, const QueueEntry& entry);
+
+    public:
+
+        void Reset(int station_count) override;
+        void Push(int station_id, double key) override;
+        QueueEntry Pop() override;
+        bool Empty() const override { return heap_.empty(); }
+        QueueType GetType() const override { return QueueType::QuaternaryHeap; }
+
+};
+
+// Travel times are non-negative doubles, whose IEEE-754 bit patterns sort in the same order as their values,
+// so the radix heap works on exact keys without rounding minutes to integers
+// Keys must not drop below the last popped key; smaller keys are clamped up to it
+class RadixHeapQueue : public MinQueue {
+    private:
+
+        struct RadixEntry {
+            std::uint64_t bits;
+            QueueEntry entry;
+        };
+
+        // Bucket i holds keys whose highest bit differing from last_bits_ is bit i - 1; bucket 0 holds last_bits_
+        std::array<std::vector<RadixEntry>, 65> buckets_;
+        std::uint64_t last_bits_;
+        std::size_t size_;
+
+        int BucketFor(std::uint64_t bits) const;
+
+    public:
+
+        RadixHeapQueue() : last_bits_(0), size_(0) {}
+
+        void Reset(int station_count) override;
+        void Push(int station_id, double key) override;
+        QueueEntry Pop() override;
+        bool Empty() const override { return size_ == 0; }
+        QueueType GetType() const override { return QueueType::RadixHeap; }
+
+};
+
+std::unique_ptr<MinQueue> MakeMinQueue(QueueType type);
+// Name used in benchmark output, e.g. "quaternary_heap"
+const char* QueueTypeName(QueueType type);
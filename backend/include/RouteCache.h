@@ -0,0 +1,89 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "TimeSlice.h"
+
+// A finished route as returned to clients
+struct CachedRoute {
+    double estimated_time_minutes;
+    std::vector<std::string> route;
+};
+
+struct RouteCacheStats {
+    std::uint64_t hits = 0;
+    std::uint64_t misses = 0;
+    std::uint64_t insertions = 0;
+    std::uint64_t evictions = 0;
+    std::size_t entries = 0;
+    std::size_t bytes = 0;            // approximate, as charged against the budget
+    std::size_t capacity_bytes = 0;
+};
+
+// Concurrent LRU cache of route results keyed by (time slice, start station ID, end station ID).
+// Keys are spread over independently locked shards, each holding an equal share of the memory budget
+// and evicting its least recently used routes once over it. Entries are shared_ptr so a reader keeps
+// its route alive after the shard lock is released, even if the entry is evicted meanwhile.
+class RouteCache {
+    private:
+
+        struct Entry {
+            std::uint64_t key;
+            std::shared_ptr<const CachedRoute> value;
+            std::size_t bytes;
+        };
+
+        struct Shard {
+            std::mutex mutex;
+            std::list<Entry> lru;  // most recently used first
+            std::unordered_map<std::uint64_t, std::list<Entry>::iterator> index;
+            std::size_t bytes = 0;
+            std::uint64_t hits = 0;
+            std::uint64_t misses = 0;
+            std::uint64_t insertions = 0;
+            std::uint64_t evictions = 0;
+        };
+
+        std::vector<std::unique_ptr<Shard>> shards_;
+        std::size_t shard_capacity_bytes_;
+        std::atomic<std::uint64_t> generation_;
+
+        Shard& ShardFor(std::uint64_t key);
+        void EvictOverBudget(Shard& shard);
+
+        // Approximate heap footprint of one cached route including list and index nodes
+        static std::size_t EntryBytes(const CachedRoute& route);
+
+    public:
+
+        // capacity_bytes of 0 disables the cache; shard_count is rounded up to a power of two
+        explicit RouteCache(std::size_t capacity_bytes, std::size_t shard_count = 16);
+
+        RouteCache(const RouteCache&) = delete;
+        RouteCache& operator=(const RouteCache&) = delete;
+
+        static std::uint64_t MakeKey(TimeSlice slice, int start_id, int end_id);
+
+        bool IsEnabled() const { return shard_capacity_bytes_ > 0; }
+
+        // Returns the cached route, or nullptr on a miss
+        std::shared_ptr<const CachedRoute> Get(std::uint64_t key);
+
+        // Stores a route computed while Generation() returned generation. Results computed against a graph
+        // that has since been invalidated are dropped instead of being cached.
+        void Put(std::uint64_t key, CachedRoute route, std::uint64_t generation);
+
+        // Drops every entry; call whenever the graph behind the engines is reloaded
+        void Invalidate();
+        std::uint64_t Generation() const { return generation_.load(std::memory_order_acquire); }
+
+        RouteCacheStats GetStats();
+
+};
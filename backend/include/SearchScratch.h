@@ -0,0 +1,51 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include "PriorityQueue.h"
+#include "SearchState.h"
+
+// Work done by a single search, filled in when a caller passes a SearchStats pointer
+struct SearchStats {
+    std::uint64_t settled = 0;        // stations popped and expanded
+    std::uint64_t relaxed = 0;        // edges examined from settled stations
+    std::uint64_t pushes = 0;         // queue insertions
+    std::uint64_t decrease_keys = 0;  // queue key updates in place
+    std::uint64_t pops = 0;           // queue removals, including stale entries
+
+    // Adds the work of another search, such as one run on another thread
+    void Add(const SearchStats& other) {
+        settled += other.settled;
+        relaxed += other.relaxed;
+        pushes += other.pushes;
+        decrease_keys += other.decrease_keys;
+        pops += other.pops;
+    }
+
+    // Adds the queue operations performed between two snapshots of a queue's cumulative counts
+    void AddQueueOperations(const QueueStats& before, const QueueStats& after) {
+        pushes += after.pushes - before.pushes;
+        decrease_keys += after.decrease_keys - before.decrease_keys;
+        pops += after.pops - before.pops;
+    }
+};
+
+// Mutable state a search needs. Engines do not own one: they borrow the calling thread's,
+// so one engine object can serve concurrent queries without a lock and without sharing state
+struct SearchScratch {
+    SearchState state;
+    std::unique_ptr<MinQueue> queue;
+
+    // Starts a new search over station_count stations
+    void Reset(int station_count) {
+        state.Reset(station_count);
+        queue->Reset(station_count);
+    }
+};
+
+// Scratch slots per queue type: bidirectional searches keep one frontier in each
+constexpr int kScratchSlots = 2;
+
+// Returns the calling thread's scratch for queue_type and slot, created on first use
+// A thread runs one search at a time, so the scratch is free again once the engine call returns
+SearchScratch& GetThreadScratch(QueueType queue_type, int slot = 0);
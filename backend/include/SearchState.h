@@ -0,0 +1,50 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+// Per-station shortest path state kept in flat vectors indexed by dense station ID and reused across queries
+// A station's entries only count when its stamp matches the current generation,
+// so starting a new search is O(1) and a whole query costs O(stations touched)
+class SearchState {
+    private:
+
+        std::vector<double> distances_;
+        std::vector<int> predecessors_;
+        std::vector<std::uint32_t> stamps_;
+        std::uint32_t generation_;
+
+    public:
+
+        SearchState() : generation_(0) {}
+
+        // Starts a new search over station_count stations. Only allocates when the graph has grown
+        void Reset(int station_count) {
+            if (static_cast<int>(stamps_.size()) < station_count) {
+                distances_.resize(station_count);
+                predecessors_.resize(station_count);
+                stamps_.resize(station_count, 0);
+            }
+            // Once the generation wraps around, old stamps could match again, so clear them
+            if (++generation_ == 0) {
+                std::fill(stamps_.begin(), stamps_.end(), 0);
+                generation_ = 1;
+            }
+        }
+
+        bool IsReached(int station_id) const { return stamps_[station_id] == generation_; }
+        double GetDistance(int station_id) const {
+            return IsReached(station_id) ? distances_[station_id] : std::numeric_limits<double>::infinity();
+        }
+        // Returns -1 for the start station and for stations this search has not reached
+        int GetPredecessor(int station_id) const { return IsReached(station_id) ? predecessors_[station_id] : -1; }
+
+        void SetDistance(int station_id, double distance, int predecessor) {
+            distances_[station_id] = distance;
+            predecessors_[station_id] = predecessor;
+            stamps_[station_id] = generation_;
+        }
+
+};
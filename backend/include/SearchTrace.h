@@ -0,0 +1,44 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+// Trace sinks the search engines report their steps to. Engines take the sink as a template parameter,
+// so the hooks of NullTrace are empty inline calls that compile to nothing in untraced searches.
+// A sink provides:
+//     OnPush(station_id, key)                  queue insertion or key decrease
+//     OnPop(station_id, key, stale)            queue removal; stale entries are skipped by the search
+//     OnSettle(station_id, time)               station expanded with its final time
+//     OnRelax(from_id, to_id, time, improved)  edge examined; improved when it lowered to_id's time
+
+struct NullTrace {
+    static constexpr bool kEnabled = false;
+
+    void OnPush(int, double) {}
+    void OnPop(int, double, bool) {}
+    void OnSettle(int, double) {}
+    void OnRelax(int, int, double, bool) {}
+};
+
+// Records the settle order and counts every relaxation and queue operation of one search
+struct RecordingTrace {
+    static constexpr bool kEnabled = true;
+
+    std::vector<int> settled;  // station IDs in the order they were settled
+    std::uint64_t relaxations = 0;
+    std::uint64_t improving_relaxations = 0;
+    std::uint64_t pushes = 0;
+    std::uint64_t pops = 0;
+    std::uint64_t stale_pops = 0;
+
+    void OnPush(int, double) { ++pushes; }
+    void OnPop(int, double, bool stale) {
+        ++pops;
+        stale_pops += stale ? 1 : 0;
+    }
+    void OnSettle(int station_id, double) { settled.push_back(station_id); }
+    void OnRelax(int, int, double, bool improved) {
+        ++relaxations;
+        improving_relaxations += improved ? 1 : 0;
+    }
+};
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <cstddef>
+#include <ostream>
+#include <string>
+#include "Logger.h"
+
+// Runtime settings for subway_server, filled from defaults, an optional config file, then command line flags
+// Timeouts are in seconds; a zero worker_threads means one worker per hardware thread
+struct ServerConfig {
+    std::string host = "localhost";
+    int port = 8080;
+
+    unsigned worker_threads = 0;
+    std::size_t max_queued_requests = 0;  // 0 leaves the worker queue unbounded
+
+    std::size_t keep_alive_max_count = 100;
+    long keep_alive_timeout = 5;
+    long read_timeout = 5;
+    long write_timeout = 5;
+    std::size_t payload_max_length = 1 << 20;
+
+    std::size_t route_cache_mb = 64;  // 0 disables the route cache
+    std::size_t route_cache_shards = 16;
+
+    // Precompute all-pairs tables in the background; opt-in, since they take about 128 MiB and every build
+    // thread at startup while the hierarchies are being built too
+    bool route_tables = false;
+    unsigned route_table_threads = 0;
+    int landmarks = 8;  // ALT landmarks per slice for A*
+    bool contraction_hierarchies = true;  // build hierarchies in the background, used until the tables are ready
+
+    std::size_t batch_max_queries = 10000;  // largest /api/find-routes/batch request
+    std::size_t matrix_max_cells = 1000000;  // largest /api/matrix request, sources times targets
+    // Threads answering one batch or matrix request, 0 = one per hardware thread: the request's worker thread and
+    // threads of a pool kept for the whole process, whose search scratch carries over between requests
+    unsigned batch_threads = 0;
+
+    LogLevel log_level = LogLevel::Info;  // debug lines also need a build with SUBWAY_LOG_MIN_LEVEL at 0
+
+    std::string csv_path = "../../../data/subway_travel_times.csv";
+    std::string snapshot_path = "../../../data/subway_travel_times.snapshot";
+
+    // Worker count after resolving 0 to the hardware thread count
+    unsigned EffectiveWorkerThreads() const;
+};
+
+// Applies "--name value" / "--name=value" flags on top of config. "--config <file>" reads
+// "name = value" lines from a file at that point, so later flags still override it.
+// Returns false with a message in error on an unknown name or a bad value; "--help" sets help_requested.
+bool ParseServerConfig(int argc, const char* const argv[], ServerConfig& config, std::string& error,
+                       bool* help_requested = nullptr);
+
+// Reads "name = value" lines (same names as the flags, '#' starts a comment) into config
+bool LoadServerConfigFile(const std::string& file_path, ServerConfig& config, std::string& error);
+
+// Prints the effective settings, one per line, for the startup log
+void PrintServerConfig(std::ostream& out, const ServerConfig& config);
+
+// Flag summary for --help and parse errors
+const char* ServerConfigUsage();
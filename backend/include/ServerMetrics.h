@@ -0,0 +1,80 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include "LatencyHistogram.h"
+#include "RouteCache.h"
+
+// Counters and histograms of the HTTP server, rendered in the Prometheus text exposition format by /metrics.
+// Every metric is allocated up front and updated with relaxed atomics, so recording from request handlers
+// takes no lock and a scrape never blocks a request. Durations are recorded in nanoseconds and exported in
+// seconds, as Prometheus expects.
+class ServerMetrics {
+    public:
+
+        // Paths are mapped onto this closed set so unknown paths cannot grow the label space
+        enum class Endpoint {
+            Health, FindRoute, FindRoutesBatch, Matrix, Isochrone, CompareAlgorithms, Metrics, Other, kCount
+        };
+
+        // Steps of a request handler timed separately from the search
+        enum class Stage { JsonParse, StationLookup, CacheLookup, Serialization, kCount };
+
+        enum class Algorithm {
+            Dijkstra, AStar, BidirectionalDijkstra, ContractionHierarchy, AlternativeRoutes, TimeDependentDijkstra,
+            RouteTable, kCount
+        };
+
+        static constexpr int kMaxStatus = 600;
+
+    private:
+
+        static constexpr std::size_t kEndpointCount = static_cast<std::size_t>(Endpoint::kCount);
+        static constexpr std::size_t kStageCount = static_cast<std::size_t>(Stage::kCount);
+        static constexpr std::size_t kAlgorithmCount = static_cast<std::size_t>(Algorithm::kCount);
+
+        std::array<std::array<std::atomic<std::uint64_t>, kMaxStatus>, kEndpointCount> requests_;
+        std::array<LatencyHistogram, kEndpointCount> request_duration_ns_;
+        std::array<LatencyHistogram, kStageCount> stage_duration_ns_;
+        std::array<LatencyHistogram, kAlgorithmCount> search_duration_ns_;
+        std::array<LatencyHistogram, kAlgorithmCount> settled_stations_;
+
+        // Helper function for Render
+        // Writes one histogram series as cumulative _bucket lines plus _sum and _count, scaling values by scale
+        static void RenderHistogram(std::ostream& out, const std::string& name, const std::string& labels,
+                                    const LatencyHistogram& histogram, const double* bounds, std::size_t bound_count,
+                                    double scale);
+
+    public:
+
+        ServerMetrics();
+
+        ServerMetrics(const ServerMetrics&) = delete;
+        ServerMetrics& operator=(const ServerMetrics&) = delete;
+
+        static Endpoint EndpointForPath(const std::string& path);
+        static const char* EndpointName(Endpoint endpoint);
+        static const char* StageName(Stage stage);
+        static const char* AlgorithmName(Algorithm algorithm);
+
+        // Nanoseconds since start, for the Record functions below
+        static std::uint64_t NanosecondsSince(std::chrono::steady_clock::time_point start) {
+            return static_cast<std::uint64_t>(
+                std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count());
+        }
+
+        // A finished request with its response status and total time in the server
+        void RecordRequest(Endpoint endpoint, int status, std::uint64_t duration_ns);
+        void RecordStage(Stage stage, std::uint64_t duration_ns);
+        // One search, with the stations it settled if the engine counts them
+        void RecordSearch(Algorithm algorithm, std::uint64_t duration_ns);
+        void RecordSearch(Algorithm algorithm, std::uint64_t duration_ns, std::uint64_t settled_stations);
+
+        // Prometheus text format of every metric, followed by the route cache counters
+        std::string Render(const RouteCacheStats& route_cache) const;
+
+};
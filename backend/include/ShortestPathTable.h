@@ -0,0 +1,78 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <thread>
+#include <utility>
+#include <vector>
+#include "AdjacencyList.h"
+
+// Summary of a table build, for the startup log and capacity planning
+struct ShortestPathTableReport {
+    int slices = 0;
+    int stations = 0;
+    std::uint64_t searches = 0;       // one-to-all searches run, one per station per slice
+    unsigned int threads = 0;
+    double build_seconds = 0;
+    std::size_t table_bytes = 0;      // distance and next hop matrices
+    std::size_t graph_bytes = 0;      // CSR graphs of the same slices, for comparison
+};
+
+// All-pairs quickest times and next hops for every time slice, precomputed with one Dijkstra search per
+// station so a route query is a table lookup plus a walk of at most station_count hops.
+// Each slice stores station_count^2 float times and 16-bit next hops (6 bytes per pair).
+// The table is immutable once built; queries are thread safe and answer only after IsReady().
+class ShortestPathTable {
+    private:
+
+        // Row-major station_count x station_count matrices of one slice; empty when the slice has no data
+        struct SliceTable {
+            std::vector<float> times;
+            std::vector<std::uint16_t> next_hops;
+        };
+
+        const AdjacencyList* adj_list_;
+        int station_count_;
+        std::vector<SliceTable> slices_;  // indexed by TimeSlice::Index()
+        ShortestPathTableReport report_;
+        std::atomic<bool> ready_;
+        std::thread builder_;
+
+        // Helper function for Build
+        // Fills the row of start_id in table with a one-to-all Dijkstra search on graph
+        static void FillRow(const CsrGraph& graph, int start_id, SliceTable& table);
+
+    public:
+
+        // Next hop of unreachable pairs; also caps the station count at 65535
+        static constexpr std::uint16_t kNoHop = 0xFFFF;
+
+        explicit ShortestPathTable(const AdjacencyList* adj_list);
+        ~ShortestPathTable();
+
+        ShortestPathTable(const ShortestPathTable&) = delete;
+        ShortestPathTable& operator=(const ShortestPathTable&) = delete;
+
+        // Builds the tables of the given slices (every slice with data when empty) on thread_count threads
+        // (0 = one per hardware thread) and blocks until done. Returns false if the graph has too many stations.
+        // Call once, before any query.
+        bool Build(unsigned int thread_count = 0, const std::vector<TimeSlice>& slices = {});
+        // Runs Build on a background thread; IsReady() turns true once it finishes
+        void StartBackgroundBuild(unsigned int thread_count = 0);
+
+        bool IsReady() const { return ready_.load(std::memory_order_acquire); }
+        bool HasSlice(TimeSlice slice) const;
+
+        // Quickest time between two stations as stored in the table (float), infinity when unreachable
+        float GetTime(TimeSlice slice, int start_id, int end_id) const;
+        // Same contract as Dijkstra::GetQuickestPath: walks the next hops and sums the exact edge weights.
+        // Returns -1 and an empty path when the slice is not in the table or the stations are invalid
+        std::pair<double, std::vector<Station>> GetQuickestPath(TimeSlice slice, int start_id, int end_id) const;
+
+        // Valid once IsReady()
+        const ShortestPathTableReport& GetReport() const { return report_; }
+        static void PrintReport(std::ostream& out, const ShortestPathTableReport& report);
+
+};
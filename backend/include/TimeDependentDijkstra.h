@@ -0,0 +1,96 @@
+#pragma once
+
+#include <array>
+#include <utility>
+#include <vector>
+#include "AdjacencyList.h"
+#include "PriorityQueue.h"
+#include "SearchScratch.h"
+
+// Time-dependent routing across time slice boundaries. The static engines price a whole trip with the slice it
+// starts in; here every edge is priced at the time the traveller reaches it, so a trip leaving at 08:55 runs on
+// morning rush times at first and on midday times later on.
+// The five time-of-day slices of each (month, day of week) are merged once, in Build, into one CSR graph whose
+// edges carry a weight per time of day, plus the previous day's evening and the next day's early morning for
+// trips around midnight. Queries only read these graphs. An edge's time at minute t is interpolated between
+// the midpoints of the bucket containing t and the neighbouring bucket on t's side, or is that bucket's weight
+// if the neighbour lacks the edge. When the bucket containing t lacks the edge, the traveller waits for the next
+// bucket that has it, into later days if need be. Interpolation and waiting keep t + time(t) from decreasing
+// (FIFO: leaving later never arrives earlier) as long as no edge's time drops faster than the clock runs
+// between buckets; Build clamps each edge's weights over its whole week, midnights included, where one would.
+// With FIFO edges, Dijkstra on arrival times finds the earliest arrival.
+class TimeDependentDijkstra {
+    public:
+
+        static constexpr double kMinutesPerDay = 24 * 60;
+
+    private:
+
+        // Weight columns of an edge: previous day's evening, the five buckets of the day, next day's early morning
+        static constexpr int kColumnCount = TimeSlice::kTimeOfDayCount + 2;
+        // Minute of the departure day at each column's bucket start and midpoint
+        static const std::array<double, kColumnCount> kColumnStarts;
+        static const std::array<double, kColumnCount> kColumnMidpoints;
+
+        struct DayGraph {
+            std::vector<int> offsets;  // station_count + 1 entries, empty if the day has no data
+            std::vector<int> targets;
+            // weights[edge * kColumnCount + column]: quickest time of the edge in that column, infinity if absent
+            std::vector<double> weights;
+
+            bool IsBuilt() const { return !offsets.empty(); }
+            // Index of the edge between two stations, or -1
+            int FindEdge(int from_id, int to_id) const;
+        };
+
+        const AdjacencyList* adj_list_;
+        QueueType queue_type_;
+        std::vector<DayGraph> days_;  // indexed by DayIndex
+
+        static int DayIndex(Month month, DayOfWeek day) {
+            return static_cast<int>(month) * TimeSlice::kDayOfWeekCount + static_cast<int>(day);
+        }
+        // Helper function for Build
+        // Union of the day's slices, with a weight column per time of day
+        DayGraph MergeDay(Month month, DayOfWeek day) const;
+        // Helper function for Build
+        // Raises the edge's weights over the month's week until none drops faster than the clock between buckets
+        void ClampWeek(Month month, int from_id, int to_id);
+        // Helper function for the searches
+        // Time of the edge with the given weight columns when reached at minute_of_day, including any wait for a
+        // bucket that has it; infinity if none does
+        static double EdgeTimeAt(const double* columns, double minute_of_day);
+        // Helper function for the searches
+        // Time of the day graph's edge when reached at minute_of_day, waiting into later days if the rest of this
+        // one lacks it; infinity if no day of the week has it
+        double EdgeTimeFrom(Month month, DayOfWeek day, const DayGraph& day_graph, int from_id, int edge,
+                            double minute_of_day) const;
+        // Helper function for GetQuickestPath
+        // The day graph, day and minute of day a time in minutes after the departure day's midnight falls on
+        const DayGraph* DayAt(Month month, DayOfWeek departure_day, double minute, DayOfWeek& day,
+                              double& minute_of_day) const;
+
+    public:
+
+        explicit TimeDependentDijkstra(const AdjacencyList* adj_list, QueueType queue_type = QueueType::QuaternaryHeap)
+            : adj_list_(adj_list), queue_type_(queue_type) {}
+
+        // Merges the slices of every (month, day of week) with data. Call once, before any query
+        void Build();
+
+        // Bucket that a minute of the day (0 to 1440) falls in, using the same hours as the HTTP server
+        static TimeOfDay TimeOfDayAt(double minute_of_day);
+
+        // Time of the edge between two stations when reached at minute_of_day on that day, including any wait for a
+        // later bucket that has it; infinity if no bucket up to the next day's early morning does
+        double EdgeTime(Month month, DayOfWeek day, int from_id, int to_id, double minute_of_day) const;
+
+        // Earliest arrival from start_id to end_id leaving at departure_minute (minutes after midnight) on the
+        // given month and day. Returns the travel time in minutes and the path, with the same sentinels as
+        // Dijkstra::GetQuickestPath: -1 for a bad station or a day without data, infinity if unreachable.
+        // Thread safe like the other engines once built
+        std::pair<double, std::vector<Station>> GetQuickestPath(Month month, DayOfWeek day, double departure_minute,
+                                                                int start_id, int end_id,
+                                                                SearchStats* stats = nullptr) const;
+
+};
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <string>
+
+// Closed vocabularies of the three composite key fields, in the spelling used by the CSV
+enum class Month : std::uint8_t {
+    January, February, March, April, May, June,
+    July, August, September, October, November, December,
+};
+
+enum class TimeOfDay : std::uint8_t {
+    EarlyMorning, MorningRush, Midday, EveningRush, Evening,
+};
+
+enum class DayOfWeek : std::uint8_t {
+    Monday, Tuesday, Wednesday, Thursday, Friday, Saturday, Sunday,
+};
+
+// Typed composite key packed into a single small integer
+// Index() is dense in [0, kCount), so per-slice data can live in flat arrays instead of hash maps
+class TimeSlice {
+    private:
+
+        std::uint16_t index_;
+
+        explicit TimeSlice(std::uint16_t index) : index_(index) {}
+
+    public:
+
+        static constexpr int kMonthCount = 12;
+        static constexpr int kTimeOfDayCount = 5;
+        static constexpr int kDayOfWeekCount = 7;
+        static constexpr int kCount = kMonthCount * kTimeOfDayCount * kDayOfWeekCount;
+
+        // Default constructed slices are invalid
+        TimeSlice() : index_(kCount) {}
+        TimeSlice(Month month, TimeOfDay time_of_day, DayOfWeek day_of_week)
+            : index_(static_cast<std::uint16_t>(
+                  (static_cast<int>(month) * kTimeOfDayCount + static_cast<int>(time_of_day)) * kDayOfWeekCount +
+                  static_cast<int>(day_of_week))) {}
+
+        // Parses a {month, time_of_day, day_of_week} composite key. Returns an invalid slice for unknown strings
+        static TimeSlice FromCompositeKey(const std::array<std::string, 3>& composite_key);
+        static TimeSlice FromIndex(int index);
+        std::array<std::string, 3> ToCompositeKey() const;
+
+        bool IsValid() const { return index_ < kCount; }
+        int Index() const { return index_; }
+        Month GetMonth() const { return static_cast<Month>(index_ / (kTimeOfDayCount * kDayOfWeekCount)); }
+        TimeOfDay GetTimeOfDay() const { return static_cast<TimeOfDay>(index_ / kDayOfWeekCount % kTimeOfDayCount); }
+        DayOfWeek GetDayOfWeek() const { return static_cast<DayOfWeek>(index_ % kDayOfWeekCount); }
+
+        bool operator==(const TimeSlice& other) const { return index_ == other.index_; }
+        bool operator!=(const TimeSlice& other) const { return index_ != other.index_; }
+
+};
@@ -1,17 +1,18 @@
 #include "../include/AStar.h"
 #include <algorithm>
-#include <unordered_set>
-#include <iostream>
+#include <sstream>
+#include "../include/Logger.h"
 
 using namespace std;
 
-unordered_map<int, vector<Edge>>* AStar::GetAdjacencyList() const {
-    return adj_lists_->GetAdjacencyList(composite_key_);
-}
-
 void AStar::SetCompositeKey(const array<string, 3>& key) {
     composite_key_ = key;
-    adj_list_ = adj_lists_->GetAdjacencyList(key);
+    slice_ = TimeSlice::FromCompositeKey(key);
+}
+
+void AStar::SetTimeSlice(TimeSlice slice) {
+    composite_key_ = slice.ToCompositeKey();
+    slice_ = slice;
 }
 
 //euclidian distance 
@@ -23,97 +24,145 @@ double AStar::Heuristic(const Station& a, const Station& b) const {
 }
 
 //uses the map to get path from start id to finish id
-vector<Station> AStar::ReconstructPath(unordered_map<int, int>& predecessors, int start_id, int end_id) const {
+vector<Station> AStar::ReconstructPath(const SearchState& state, int start_id, int end_id) const {
     vector<int> path_ids;
 
-    if (predecessors.find(end_id) == predecessors.end() && start_id != end_id) {
+    if (!state.IsReached(end_id)) {
         return {};
     }
 
     int node = end_id;
-    while (predecessors.find(node) != predecessors.end()) {
+    while (node != start_id) {
         path_ids.push_back(node);
-        node = predecessors[node];
+        node = state.GetPredecessor(node);
     }
     path_ids.push_back(start_id);
     reverse(path_ids.begin(), path_ids.end());
 
-    // Debug: Print station IDs before filtering
-    cout << "DEBUG A*: Station IDs before filtering: ";
-    for (auto id : path_ids) {
-        cout << id << " ";
+    // Debug: Log station IDs before filtering
+    if (SUBWAY_LOG_ENABLED(LogLevel::Debug)) {
+        ostringstream ids;
+        for (auto id : path_ids) {
+            ids << id << " ";
+        }
+        LOG_DEBUG("A*: Station IDs before filtering: " << ids.str());
     }
-    cout << endl;
 
     //name to station object
-    vector<Station> path;
-    unordered_set<string> seen_names;
-    for (int id : path_ids) {
-        const Station* s = adj_lists_->GetStation(id);
-        if (s && seen_names.find(s->station_name) == seen_names.end()) {
-            path.push_back(*s);
-            seen_names.insert(s->station_name);
-        }
-    }
+    vector<Station> path = adj_lists_->GetStationPath(path_ids);
 
-    // Debug: Print final station names
-    cout << "DEBUG A*: Final station names: ";
-    for (const auto& station : path) {
-        cout << station.station_name << " ";
+    // Debug: Log final station names
+    if (SUBWAY_LOG_ENABLED(LogLevel::Debug)) {
+        ostringstream names;
+        for (const auto& station : path) {
+            names << station.station_name << " ";
+        }
+        LOG_DEBUG("A*: Final station names: " << names.str());
     }
-    cout << endl;
     return path;
 }
 
-//same as the original findpath, gets hitorical data and heuristic
+//station overload, looks up the ids and searches the stored composite key
 pair<double, vector<Station>> AStar::GetQuickestPath(const Station& start_station, const Station& end_station) {
-    if (!adj_list_) return {-1.0, {}};
+    return GetQuickestPath(slice_, adj_lists_->GetStationId(start_station), adj_lists_->GetStationId(end_station));
+}
 
-    //initialization of id, and search structures
-    int start_id = adj_lists_->GetStationId(start_station);
-    int end_id = adj_lists_->GetStationId(end_station);
+pair<double, vector<Station>> AStar::GetQuickestPath(TimeSlice slice, int start_id, int end_id,
+                                                     SearchStats* stats) const {
+    NullTrace trace;
+    return Search(slice, start_id, end_id, stats, trace);
+}
 
-    if (start_id == -1 || end_id == -1) {
+pair<double, vector<Station>> AStar::GetQuickestPath(TimeSlice slice, int start_id, int end_id,
+                                                     RecordingTrace& trace, SearchStats* stats) const {
+    return Search(slice, start_id, end_id, stats, trace);
+}
+
+//same as the original findpath, gets hitorical data and heuristic
+template <typename Trace>
+pair<double, vector<Station>> AStar::Search(TimeSlice slice, int start_id, int end_id, SearchStats* stats,
+                                            Trace& trace) const {
+    const CsrGraph* graph = adj_lists_->GetCsrGraph(slice);
+    if (!graph) return {-1.0, {}};
+
+    if (start_id < 0 || end_id < 0 || start_id >= graph->StationCount() || end_id >= graph->StationCount()) {
         return {-1.0, {}};
     }
 
-    priority_queue<Node, vector<Node>, greater<Node>> open_set;
-    unordered_map<int, double> g_cost;
-    unordered_map<int, int> came_from;
+    //the calling thread's search structures, reset marks every g cost as unknown without clearing the vectors
+    SearchScratch& scratch = GetThreadScratch(queue_type_);
+    scratch.Reset(graph->StationCount());
+    SearchState& state = scratch.state;
+    MinQueue& open_set = *scratch.queue;
+    const QueueStats queue_before = open_set.GetStats();
+    uint64_t settled = 0;
+    uint64_t relaxed = 0;
+
+    //fills in stats for this search before returning
+    auto record_stats = [&]() {
+        if (stats) {
+            stats->settled += settled;
+            stats->relaxed += relaxed;
+            stats->AddQueueOperations(queue_before, open_set.GetStats());
+        }
+    };
 
-    g_cost[start_id] = 0.0;
+    state.SetDistance(start_id, 0.0, -1);
 
     const Station* goal_ptr = adj_lists_->GetStation(end_id);
-    double h_start = Heuristic(start_station, *goal_ptr);
-    open_set.push({start_id, 0.0, h_start});
+    //landmark bounds are admissible and consistent, the coordinate estimate is the fallback without them
+    const LandmarkTable::SliceLandmarks* slice_landmarks = landmarks_ ? landmarks_->GetSlice(slice) : nullptr;
+    auto heuristic = [&](int station_id) {
+        if (slice_landmarks) {
+            return slice_landmarks->LowerBound(station_id, end_id);
+        }
+        return Heuristic(*adj_lists_->GetStation(station_id), *goal_ptr);
+    };
+    double h_start = heuristic(start_id);
+    open_set.Push(start_id, h_start);
+    trace.OnPush(start_id, h_start);
 
     //A* logic
-    while (!open_set.empty()) {
-        Node current = open_set.top();
-        open_set.pop();
+    while (!open_set.Empty()) {
+        QueueEntry current = open_set.Pop();
+        double current_g = state.GetDistance(current.station_id);
+
+        //lazy queues keep old entries after a cheaper path is found, skip them
+        //g + h is recomputed exactly as it was when the current entry was pushed
+        const bool stale = current.key > current_g + heuristic(current.station_id);
+        trace.OnPop(current.station_id, current.key, stale);
+        if (stale) {
+            continue;
+        }
+        ++settled;
+        trace.OnSettle(current.station_id, current_g);
+
         //final loop
         if (current.station_id == end_id) {
-            return {g_cost[end_id], ReconstructPath(came_from, start_id, end_id)};
+            record_stats();
+            return {current_g, ReconstructPath(state, start_id, end_id)};
         }
             //checks the neighboring nodes
-        for (const Edge& edge : (*adj_list_)[current.station_id]) {
-            int neighbor_id = adj_lists_->GetStationId(edge.end_station);
-            double tentative_g = g_cost[current.station_id] + edge.travel_time;
+        for (int edge = graph->offsets[current.station_id]; edge < graph->offsets[current.station_id + 1]; ++edge) {
+            int neighbor_id = graph->targets[edge];
+            double tentative_g = current_g + graph->weights[edge];
+            ++relaxed;
 
             //compares the neighbor node time to best
-            if (!g_cost.count(neighbor_id) || tentative_g < g_cost[neighbor_id]) {
-                g_cost[neighbor_id] = tentative_g;
-                
-                const Station* neighbor_station = adj_lists_->GetStation(neighbor_id);
-                double h = Heuristic(*neighbor_station, *goal_ptr);
+            const bool improved = tentative_g < state.GetDistance(neighbor_id);
+            trace.OnRelax(current.station_id, neighbor_id, tentative_g, improved);
+            if (improved) {
+                state.SetDistance(neighbor_id, tentative_g, current.station_id);
+
+                double h = heuristic(neighbor_id);
                 double f = tentative_g + h; //combines the historical and heuristic 
 
-                open_set.push({neighbor_id, tentative_g, f});
-                came_from[neighbor_id] = current.station_id;
+                open_set.Push(neighbor_id, f);
+                trace.OnPush(neighbor_id, f);
             }
         }
     }
 
+    record_stats();
     return {-1.0, {}};
 }
-
@@ -1,7 +1,48 @@
+#include <algorithm>
+#include <cctype>
+#include <charconv>
+#include <exception>
 #include <fstream>
 #include <sstream>
 #include <iostream>
+#include <limits>
+#include <stdexcept>
+#include <thread>
+#include <unordered_set>
 #include "../include/AdjacencyList.h"
+#include "../include/MappedFile.h"
+
+namespace {
+
+// Returns the text before the next delimiter and advances text past the delimiter
+std::string_view NextToken(std::string_view& text, char delimiter) {
+  const auto delimiter_pos = text.find(delimiter);
+  const std::string_view token = text.substr(0, delimiter_pos);
+  text.remove_prefix(delimiter_pos == std::string_view::npos ? text.size() : delimiter_pos + 1);
+  return token;
+}
+
+// Parses a number in place without allocating, accepting the same padding std::stod does
+double ParseDouble(std::string_view token) {
+  while (!token.empty() && std::isspace(static_cast<unsigned char>(token.front()))) {
+    token.remove_prefix(1);
+  }
+  while (!token.empty() && std::isspace(static_cast<unsigned char>(token.back()))) {
+    token.remove_suffix(1);
+  }
+  if (!token.empty() && token.front() == '+') {
+    token.remove_prefix(1);
+  }
+
+  double value = 0.0;
+  const auto result = std::from_chars(token.data(), token.data() + token.size(), value);
+  if (result.ec != std::errc() || result.ptr != token.data() + token.size()) {
+    throw std::invalid_argument("LoadFromCSV: invalid number '" + std::string(token) + "'");
+  }
+  return value;
+}
+
+}  // namespace
 
 int AdjacencyList::AddStation(const Station& station) {
   // Check if station already exists
@@ -13,7 +54,7 @@ int AdjacencyList::AddStation(const Station& station) {
   // Add station to bidirectional maps with next available ID
   const int new_id = station_count_++;
   station_to_id_[station] = new_id;
-  id_to_station_[new_id] = station;
+  id_to_station_.push_back(station);
 
   // Add station to name to station map
   name_to_station_[station.station_name] = station;
@@ -24,18 +65,33 @@ int AdjacencyList::AddStation(const Station& station) {
 void AdjacencyList::AddEdge(const std::array<std::string, 3>& composite_key,
             const Station& start_station, const Station& end_station, double travel_time) {
 
-  // Auto-add stations if they don't exist and get start ID
+  // Auto-add stations if they don't exist and get their IDs
   const int start_id = AddStation(start_station);
-  AddStation(end_station);
+  const int end_id = AddStation(end_station);
 
   // Create Edge
-  const Edge edge{start_station, end_station, travel_time};
+  const Edge edge{start_id, end_id, travel_time};
 
   // Add Edge to adjacency list
   adj_list_[composite_key][start_id].push_back(edge);
 }
 
-void AdjacencyList::LoadFromCSV(const std::string& file_path) {
+void AdjacencyList::LoadFromCSV(const std::string& file_path, CsvLoadMode mode, unsigned int thread_count) {
+    switch (mode) {
+        case CsvLoadMode::Stream:
+            LoadFromStreamCSV(file_path);
+            break;
+        case CsvLoadMode::Mapped:
+            LoadFromMappedCSV(file_path, 1);
+            break;
+        case CsvLoadMode::Parallel:
+            LoadFromMappedCSV(file_path, thread_count);
+            break;
+    }
+    BuildCsrGraphs();
+}
+
+void AdjacencyList::LoadFromStreamCSV(const std::string& file_path) {
   // Open file_path using ifstream
   // For each line in the CSV (skipping the first)
     // Used getline and stringstream to get the text before a comma for each value in the line
@@ -97,10 +153,176 @@ void AdjacencyList::LoadFromCSV(const std::string& file_path) {
     }
 }
 
+// Graph fragment parsed from one chunk of the CSV, using chunk-local station and key IDs
+// Local IDs are assigned in order of first appearance so merging chunks in file order reproduces global IDs
+struct AdjacencyList::PartialGraph {
+    struct Row {
+        int key_id;
+        int start_id;
+        int end_id;
+        double travel_time;
+    };
+
+    std::vector<Station> stations;
+    std::vector<std::array<std::string, 3>> composite_keys;
+    std::vector<Row> rows;
+};
+
+void AdjacencyList::ParseChunk(std::string_view text, PartialGraph& partial) {
+    // Every field is a string_view into the mapped file,
+    // so a row only allocates when it introduces a new station or composite key to this chunk
+    std::unordered_map<std::string_view, int> station_ids;
+    std::unordered_map<std::string_view, int> key_ids;
+
+    // Rows are grouped by composite key, so only look a key up when its text changes
+    std::string_view last_key_text;
+    int key_id = -1;
+
+    // Consumes the three station fields from row and returns the station's local ID, adding the station if it is new
+    auto intern_station = [&partial, &station_ids](std::string_view& row) {
+        const char* station_begin = row.data();
+        const std::string_view name = NextToken(row, ',');
+        const std::string_view latitude = NextToken(row, ',');
+        const std::string_view longitude = NextToken(row, ',');
+        const std::string_view station_text(station_begin, longitude.data() + longitude.size() - station_begin);
+
+        auto it = station_ids.find(station_text);
+        if (it != station_ids.end()) {
+            return it->second;
+        }
+        const int station_id = static_cast<int>(partial.stations.size());
+        partial.stations.push_back(Station{std::string(name), {ParseDouble(latitude), ParseDouble(longitude)}});
+        station_ids.emplace(station_text, station_id);
+        return station_id;
+    };
+
+    while (!text.empty()) {
+        std::string_view row = NextToken(text, '\n');
+        if (!row.empty() && row.back() == '\r') {
+            row.remove_suffix(1);
+        }
+        if (row.empty()) {
+            continue;
+        }
+
+        // Parse each field
+        const char* key_begin = row.data();
+        const std::string_view month = NextToken(row, ',');
+        const std::string_view time_of_day = NextToken(row, ',');
+        const std::string_view day_of_week = NextToken(row, ',');
+        const std::string_view key_text(key_begin, day_of_week.data() + day_of_week.size() - key_begin);
+
+        const int start_id = intern_station(row);
+        const int end_id = intern_station(row);
+        const double avg_time = ParseDouble(NextToken(row, ','));
+
+        if (key_id == -1 || key_text != last_key_text) {
+            auto it = key_ids.find(key_text);
+            if (it == key_ids.end()) {
+                it = key_ids.emplace(key_text, static_cast<int>(partial.composite_keys.size())).first;
+                partial.composite_keys.push_back({std::string(month), std::string(time_of_day), std::string(day_of_week)});
+            }
+            key_id = it->second;
+            last_key_text = key_text;
+        }
+
+        partial.rows.push_back({key_id, start_id, end_id, avg_time});
+    }
+}
+
+void AdjacencyList::MergePartialGraph(const PartialGraph& partial) {
+    // Stations are added in local first-appearance order, which is the order a sequential load would add them
+    std::vector<int> station_ids;
+    station_ids.reserve(partial.stations.size());
+    for (const auto& station : partial.stations) {
+        station_ids.push_back(AddStation(station));
+    }
+
+    std::vector<std::unordered_map<int, std::vector<Edge>>*> key_adj_lists;
+    key_adj_lists.reserve(partial.composite_keys.size());
+    for (const auto& composite_key : partial.composite_keys) {
+        key_adj_lists.push_back(&adj_list_[composite_key]);
+    }
+
+    for (const auto& row : partial.rows) {
+        const int start_id = station_ids[row.start_id];
+        const int end_id = station_ids[row.end_id];
+        (*key_adj_lists[row.key_id])[start_id].push_back(Edge{start_id, end_id, row.travel_time});
+    }
+}
+
+void AdjacencyList::LoadFromMappedCSV(const std::string& file_path, unsigned int thread_count) {
+    MappedFile file(file_path);
+    if (!file.IsOpen()) {
+        std::cerr << "Error opening file: " << file_path << std::endl;
+        return;
+    }
+
+    std::string_view text = file.View();
+    NextToken(text, '\n'); // Skip header
+
+    // Split the rows into thread_count chunks, moving each split point forward to the next line start
+    if (thread_count == 0) {
+        thread_count = std::max(1u, std::thread::hardware_concurrency());
+    }
+    std::vector<std::string_view> chunks;
+    const std::size_t target_size = text.size() / thread_count + 1;
+    while (!text.empty()) {
+        std::size_t chunk_size = std::min(target_size, text.size());
+        const auto line_end = text.find('\n', chunk_size - 1);
+        chunk_size = line_end == std::string_view::npos ? text.size() : line_end + 1;
+        chunks.push_back(text.substr(0, chunk_size));
+        text.remove_prefix(chunk_size);
+    }
+
+    // Parse every chunk into its own partial graph, so workers never share state
+    std::vector<PartialGraph> partials(chunks.size());
+    if (chunks.size() <= 1) {
+        for (std::size_t i = 0; i < chunks.size(); ++i) {
+            ParseChunk(chunks[i], partials[i]);
+        }
+    } else {
+        std::vector<std::exception_ptr> errors(chunks.size());
+        std::vector<std::thread> workers;
+        workers.reserve(chunks.size());
+        for (std::size_t i = 0; i < chunks.size(); ++i) {
+            workers.emplace_back([&chunks, &partials, &errors, i]() {
+                try {
+                    ParseChunk(chunks[i], partials[i]);
+                } catch (...) {
+                    errors[i] = std::current_exception();
+                }
+            });
+        }
+        for (auto& worker : workers) {
+            worker.join();
+        }
+        for (const auto& error : errors) {
+            if (error) {
+                std::rethrow_exception(error);
+            }
+        }
+    }
+
+    // Merge in file order so station IDs and edge order match a sequential load for any thread count
+    for (const auto& partial : partials) {
+        MergePartialGraph(partial);
+    }
+}
+
+double CsrGraph::EdgeWeight(int from_id, int to_id) const {
+    double weight = std::numeric_limits<double>::infinity();
+    for (int edge = offsets[from_id]; edge < offsets[from_id + 1]; ++edge) {
+        if (targets[edge] == to_id) {
+            weight = std::min(weight, weights[edge]);
+        }
+    }
+    return weight;
+}
+
 const Station* AdjacencyList::GetStation(int station_id) const {
-    auto it = id_to_station_.find(station_id);
-    if (it != id_to_station_.end()) {
-        return &(it->second);
+    if (station_id >= 0 && station_id < station_count_) {
+        return &id_to_station_[station_id];
     }
     return nullptr;
 }
@@ -121,10 +343,160 @@ const int AdjacencyList::GetStationId(const Station& station) const {
     return -1; // Not found
 }
 
+std::vector<Station> AdjacencyList::GetStationPath(const std::vector<int>& station_ids) const {
+    // Convert station IDs to Station objects, ensuring no duplicates by station name
+    std::vector<Station> path;
+    path.reserve(station_ids.size());
+    std::unordered_set<std::string> seen_names;
+    for (int station_id : station_ids) {
+        const Station* station = GetStation(station_id);
+        if (station && seen_names.insert(station->station_name).second) {
+            path.push_back(*station);
+        }
+    }
+    return path;
+}
+
 std::unordered_map<int, std::vector<Edge>>* AdjacencyList::GetAdjacencyList(const std::array<std::string, 3>& composite_key) {
     auto it = adj_list_.find(composite_key);
     if (it != adj_list_.end()) {
         return &(it->second);
     }
+    // Loaded from a snapshot: rebuild the list from the slice's CSR graph
+    const CsrGraph* graph = snapshot_ ? GetCsrGraph(composite_key) : nullptr;
+    if (graph == nullptr) {
+        return nullptr;
+    }
+    auto& adjacency = adj_list_[composite_key];
+    for (int station_id = 0; station_id < graph->StationCount(); ++station_id) {
+        for (int edge = graph->offsets[station_id]; edge < graph->offsets[station_id + 1]; ++edge) {
+            adjacency[station_id].push_back(Edge{station_id, graph->targets[edge], graph->weights[edge]});
+        }
+    }
+    return &adjacency;
+}
+
+void AdjacencyList::BuildCsrGraphs() {
+    slice_graphs_.assign(TimeSlice::kCount, CsrGraph{});
+    for (const auto& pair : adj_list_) {
+        const TimeSlice slice = TimeSlice::FromCompositeKey(pair.first);
+        if (!slice.IsValid()) {
+            std::cerr << "Skipping unknown composite key: " << pair.first[0] << ", " << pair.first[1] << ", "
+                      << pair.first[2] << std::endl;
+            continue;
+        }
+
+        std::vector<int> offsets(station_count_ + 1, 0);
+
+        // Count each station's edges, then prefix sum the counts into offsets
+        std::size_t edge_count = 0;
+        for (const auto& station_edges : pair.second) {
+            offsets[station_edges.first + 1] = static_cast<int>(station_edges.second.size());
+            edge_count += station_edges.second.size();
+        }
+        for (int station_id = 0; station_id < station_count_; ++station_id) {
+            offsets[station_id + 1] += offsets[station_id];
+        }
+
+        std::vector<int> targets(edge_count);
+        std::vector<double> weights(edge_count);
+        for (const auto& station_edges : pair.second) {
+            int edge_index = offsets[station_edges.first];
+            for (const Edge& edge : station_edges.second) {
+                targets[edge_index] = edge.end_id;
+                weights[edge_index] = edge.travel_time;
+                ++edge_index;
+            }
+        }
+
+        CsrGraph& graph = slice_graphs_[slice.Index()];
+        graph.offsets = CsrArray<int>(std::move(offsets));
+        graph.targets = CsrArray<int>(std::move(targets));
+        graph.weights = CsrArray<double>(std::move(weights));
+    }
+    BuildReverseCsrGraphs();
+    // Nothing views a snapshot any more
+    snapshot_.reset();
+}
+
+void AdjacencyList::BuildReverseCsrGraphs() {
+    reverse_slice_graphs_.assign(TimeSlice::kCount, CsrGraph{});
+    for (int index = 0; index < TimeSlice::kCount; ++index) {
+        const CsrGraph& graph = slice_graphs_[index];
+        if (graph.offsets.empty()) {
+            continue;
+        }
+        const int station_count = graph.StationCount();
+        std::vector<int> offsets(station_count + 1, 0);
+
+        // Count the edges arriving at each station, then prefix sum the counts into offsets
+        for (int target : graph.targets) {
+            offsets[target + 1]++;
+        }
+        for (int station_id = 0; station_id < station_count; ++station_id) {
+            offsets[station_id + 1] += offsets[station_id];
+        }
+
+        // Fill in start station order, so each station's reversed edges stay in a deterministic order
+        std::vector<int> next_edge(offsets.begin(), offsets.end() - 1);
+        std::vector<int> targets(graph.targets.size());
+        std::vector<double> weights(graph.weights.size());
+        for (int station_id = 0; station_id < station_count; ++station_id) {
+            for (int edge = graph.offsets[station_id]; edge < graph.offsets[station_id + 1]; ++edge) {
+                const int reverse_edge = next_edge[graph.targets[edge]]++;
+                targets[reverse_edge] = station_id;
+                weights[reverse_edge] = graph.weights[edge];
+            }
+        }
+
+        CsrGraph& reverse = reverse_slice_graphs_[index];
+        reverse.offsets = CsrArray<int>(std::move(offsets));
+        reverse.targets = CsrArray<int>(std::move(targets));
+        reverse.weights = CsrArray<double>(std::move(weights));
+    }
+}
+
+const CsrGraph* AdjacencyList::GetCsrGraph(const std::array<std::string, 3>& composite_key) const {
+    return GetCsrGraph(TimeSlice::FromCompositeKey(composite_key));
+}
+
+const CsrGraph* AdjacencyList::GetCsrGraph(TimeSlice slice) const {
+    if (slice.IsValid() && !slice_graphs_[slice.Index()].offsets.empty()) {
+        return &slice_graphs_[slice.Index()];
+    }
+    return nullptr;
+}
+
+const CsrGraph* AdjacencyList::GetReverseCsrGraph(TimeSlice slice) const {
+    if (slice.IsValid() && !reverse_slice_graphs_[slice.Index()].offsets.empty()) {
+        return &reverse_slice_graphs_[slice.Index()];
+    }
     return nullptr;
 }
+
+std::vector<TimeSlice> AdjacencyList::GetTimeSlices() const {
+    std::vector<TimeSlice> slices;
+    for (int index = 0; index < TimeSlice::kCount; ++index) {
+        if (!slice_graphs_[index].offsets.empty()) {
+            slices.push_back(TimeSlice::FromIndex(index));
+        }
+    }
+    return slices;
+}
+
+bool AdjacencyList::operator==(const AdjacencyList& other) const {
+    // The CSR graphs hold every station's edges in adjacency list order, and are all a snapshot keeps
+    auto same_graphs = [](const std::vector<CsrGraph>& graphs, const std::vector<CsrGraph>& other_graphs) {
+        return std::equal(graphs.begin(), graphs.end(), other_graphs.begin(), other_graphs.end(),
+                          [](const CsrGraph& graph, const CsrGraph& other_graph) {
+                              return graph.offsets == other_graph.offsets && graph.targets == other_graph.targets &&
+                                     graph.weights == other_graph.weights;
+                          });
+    };
+    return station_count_ == other.station_count_ &&
+           id_to_station_ == other.id_to_station_ &&
+           station_to_id_ == other.station_to_id_ &&
+           name_to_station_ == other.name_to_station_ &&
+           same_graphs(slice_graphs_, other.slice_graphs_) &&
+           same_graphs(reverse_slice_graphs_, other.reverse_slice_graphs_);
+}
@@ -0,0 +1,171 @@
+#include "../include/AlternativeRoutes.h"
+#include "../include/Dijkstra.h"
+#include <algorithm>
+
+bool AlternativeRoutes::AppendSpurPath(const CsrGraph& graph, const SearchState& to_end, int spur_id, int end_id,
+                                       const BannedStations& banned, const std::vector<int>& banned_next,
+                                       std::vector<int>& path, SearchStats& stats) const {
+  auto is_banned_next = [&banned_next](int station_id) {
+    return std::find(banned_next.begin(), banned_next.end(), station_id) != banned_next.end();
+  };
+
+  // The backward search's tree path is the quickest way from the spur station without bans, so if it avoids
+  // them it is also the quickest way with them
+  bool tree_path_allowed = !is_banned_next(to_end.GetPredecessor(spur_id));
+  for (int station_id = to_end.GetPredecessor(spur_id); tree_path_allowed && station_id != -1;
+       station_id = to_end.GetPredecessor(station_id)) {
+    tree_path_allowed = !banned.IsBanned(station_id);
+  }
+  if (tree_path_allowed) {
+    for (int station_id = to_end.GetPredecessor(spur_id); station_id != -1;
+         station_id = to_end.GetPredecessor(station_id)) {
+      path.push_back(station_id);
+    }
+    return true;
+  }
+
+  // Otherwise A* guided by the exact unbanned times to the end, which bans can only make longer
+  SearchScratch& scratch = GetThreadScratch(queue_type_, 0);
+  scratch.Reset(graph.StationCount());
+  const QueueStats queue_before = scratch.queue->GetStats();
+  scratch.state.SetDistance(spur_id, 0.0, -1);
+  scratch.queue->Push(spur_id, to_end.GetDistance(spur_id));
+  bool reached_end = false;
+  while (!scratch.queue->Empty()) {
+    QueueEntry curr = scratch.queue->Pop();
+    const double curr_time = scratch.state.GetDistance(curr.station_id);
+    if (curr.key > curr_time + to_end.GetDistance(curr.station_id)) {
+      continue;
+    }
+    ++stats.settled;
+    if (curr.station_id == end_id) {
+      reached_end = true;
+      break;
+    }
+
+    for (int edge = graph.offsets[curr.station_id]; edge < graph.offsets[curr.station_id + 1]; ++edge) {
+      const int to_id = graph.targets[edge];
+      ++stats.relaxed;
+      // Stations that cannot reach the end at all are never worth queueing
+      if (banned.IsBanned(to_id) || !to_end.IsReached(to_id) ||
+          (curr.station_id == spur_id && is_banned_next(to_id))) {
+        continue;
+      }
+      const double new_time = curr_time + graph.weights[edge];
+      if (new_time < scratch.state.GetDistance(to_id)) {
+        scratch.state.SetDistance(to_id, new_time, curr.station_id);
+        scratch.queue->Push(to_id, new_time + to_end.GetDistance(to_id));
+      }
+    }
+  }
+  stats.AddQueueOperations(queue_before, scratch.queue->GetStats());
+  if (!reached_end) {
+    return false;
+  }
+
+  const std::size_t spur_begin = path.size();
+  for (int station_id = end_id; station_id != spur_id; station_id = scratch.state.GetPredecessor(station_id)) {
+    path.push_back(station_id);
+  }
+  std::reverse(path.begin() + spur_begin, path.end());
+  return true;
+}
+
+std::vector<std::pair<double, std::vector<Station>>> AlternativeRoutes::GetQuickestPaths(TimeSlice slice,
+                                                                                         int start_id, int end_id,
+                                                                                         int k,
+                                                                                         SearchStats* stats) const {
+  std::vector<std::pair<double, std::vector<Station>>> routes;
+  const CsrGraph* graph = adj_list_->GetCsrGraph(slice);
+  const CsrGraph* reverse_graph = adj_list_->GetReverseCsrGraph(slice);
+  if (graph == nullptr || reverse_graph == nullptr || k <= 0 || start_id < 0 || end_id < 0 ||
+      start_id >= graph->StationCount() || end_id >= graph->StationCount()) {
+    return routes;
+  }
+  const int station_count = graph->StationCount();
+  SearchStats work;
+
+  // Backward one-to-all search from the end: every station's quickest time to the end, with its predecessor
+  // being the next station on the way there
+  SearchScratch& to_end = GetThreadScratch(queue_type_, 1);
+  Dijkstra::SearchFrom(*reverse_graph, end_id, to_end, work);
+
+  // A route as station IDs, with the index of the station where it left the route it was found from
+  struct Route {
+    double time;
+    std::vector<int> stations;
+    std::size_t deviation;
+  };
+  auto route_time = [graph](const std::vector<int>& stations) {
+    double time = 0;
+    for (std::size_t i = 0; i + 1 < stations.size(); ++i) {
+      time += graph->EdgeWeight(stations[i], stations[i + 1]);
+    }
+    return time;
+  };
+
+  std::vector<Route> found;
+  std::vector<Route> candidates;
+  if (to_end.state.IsReached(start_id)) {
+    std::vector<int> quickest;
+    for (int station_id = start_id; station_id != -1; station_id = to_end.state.GetPredecessor(station_id)) {
+      quickest.push_back(station_id);
+    }
+    found.push_back(Route{route_time(quickest), std::move(quickest), 0});
+  }
+
+  thread_local BannedStations banned;
+  std::vector<int> banned_next;
+  while (!found.empty() && static_cast<int>(found.size()) < k) {
+    const std::size_t previous_index = found.size() - 1;
+    for (std::size_t spur_index = found[previous_index].deviation;
+         spur_index + 1 < found[previous_index].stations.size(); ++spur_index) {
+      const std::vector<int>& previous = found[previous_index].stations;
+      const int spur_id = previous[spur_index];
+
+      // Routes found so far that begin like this one already continue through these stations
+      banned_next.clear();
+      for (const Route& route : found) {
+        if (route.stations.size() > spur_index + 1 &&
+            std::equal(previous.begin(), previous.begin() + spur_index + 1, route.stations.begin())) {
+          banned_next.push_back(route.stations[spur_index + 1]);
+        }
+      }
+      // Going back through the kept beginning would make a loop
+      banned.Reset(station_count);
+      for (std::size_t i = 0; i < spur_index; ++i) {
+        banned.Ban(previous[i]);
+      }
+
+      std::vector<int> stations(previous.begin(), previous.begin() + spur_index + 1);
+      if (!AppendSpurPath(*graph, to_end.state, spur_id, end_id, banned, banned_next, stations, work)) {
+        continue;
+      }
+      const bool duplicate = std::any_of(candidates.begin(), candidates.end(), [&stations](const Route& candidate) {
+        return candidate.stations == stations;
+      });
+      if (!duplicate) {
+        const double time = route_time(stations);
+        candidates.push_back(Route{time, std::move(stations), spur_index});
+      }
+    }
+    if (candidates.empty()) {
+      break;
+    }
+
+    // The quickest candidate is the next route; among equally quick ones the earliest found wins
+    auto next = std::min_element(candidates.begin(), candidates.end(),
+                                 [](const Route& a, const Route& b) { return a.time < b.time; });
+    found.push_back(std::move(*next));
+    candidates.erase(next);
+  }
+
+  // Same conversion as the other engines, so the first route reads exactly like a k = 1 answer
+  for (const Route& route : found) {
+    routes.emplace_back(route.time, adj_list_->GetStationPath(route.stations));
+  }
+  if (stats != nullptr) {
+    stats->Add(work);
+  }
+  return routes;
+}
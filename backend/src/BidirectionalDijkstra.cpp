@@ -0,0 +1,145 @@
+#include "../include/BidirectionalDijkstra.h"
+#include <algorithm>
+#include <limits>
+
+std::pair<double, std::vector<Station>> BidirectionalDijkstra::GetPath(const CsrGraph& graph,
+                                                                       const SearchState& forward,
+                                                                       const SearchState& backward,
+                                                                       int from_id, int to_id) const {
+  // Forward predecessors lead back to the start, backward predecessors lead on to the end
+  std::vector<int> station_path;
+  for (int curr_id = from_id; curr_id != -1; curr_id = forward.GetPredecessor(curr_id)) {
+    station_path.push_back(curr_id);
+  }
+  std::reverse(station_path.begin(), station_path.end());
+  if (to_id != from_id) {
+    for (int curr_id = to_id; curr_id != -1; curr_id = backward.GetPredecessor(curr_id)) {
+      station_path.push_back(curr_id);
+    }
+  }
+
+  // Add up the edge weights in path order so the time matches a forward Dijkstra search exactly
+  double total_time = 0.0;
+  for (std::size_t i = 1; i < station_path.size(); ++i) {
+    total_time += graph.EdgeWeight(station_path[i - 1], station_path[i]);
+  }
+
+  return std::make_pair(total_time, adj_lists_->GetStationPath(station_path));
+}
+
+std::pair<double, std::vector<Station>> BidirectionalDijkstra::GetQuickestPath(TimeSlice slice, int start_id,
+                                                                               int end_id, SearchStats* stats) const {
+  NullTrace trace;
+  return Search(slice, start_id, end_id, stats, trace);
+}
+
+std::pair<double, std::vector<Station>> BidirectionalDijkstra::GetQuickestPath(TimeSlice slice, int start_id,
+                                                                               int end_id, RecordingTrace& trace,
+                                                                               SearchStats* stats) const {
+  return Search(slice, start_id, end_id, stats, trace);
+}
+
+template <typename Trace>
+std::pair<double, std::vector<Station>> BidirectionalDijkstra::Search(TimeSlice slice, int start_id, int end_id,
+                                                                      SearchStats* stats, Trace& trace) const {
+  // Get the forward and reverse CSR graphs for the time slice
+  const CsrGraph* graph = adj_lists_->GetCsrGraph(slice);
+  const CsrGraph* reverse_graph = adj_lists_->GetReverseCsrGraph(slice);
+
+  // If the stations or the time slice do not exist, return sentinel value
+  if (graph == nullptr || reverse_graph == nullptr || start_id < 0 || end_id < 0 ||
+      start_id >= graph->StationCount() || end_id >= graph->StationCount()) {
+    return {-1, std::vector<Station>()};
+  }
+
+  SearchScratch& forward = GetThreadScratch(queue_type_, 0);
+  SearchScratch& backward = GetThreadScratch(queue_type_, 1);
+  forward.Reset(graph->StationCount());
+  backward.Reset(graph->StationCount());
+  const QueueStats forward_before = forward.queue->GetStats();
+  const QueueStats backward_before = backward.queue->GetStats();
+  std::uint64_t settled = 0;
+  std::uint64_t relaxed = 0;
+
+  forward.state.SetDistance(start_id, 0.0, -1);
+  forward.queue->Push(start_id, 0.0);
+  trace.OnPush(start_id, 0.0);
+  backward.state.SetDistance(end_id, 0.0, -1);
+  backward.queue->Push(end_id, 0.0);
+  trace.OnPush(end_id, 0.0);
+
+  // Best path found so far runs start -> meet_from -> meet_to -> end
+  double best_time = std::numeric_limits<double>::infinity();
+  int meet_from = -1;
+  int meet_to = -1;
+  if (start_id == end_id) {
+    best_time = 0.0;
+    meet_from = meet_to = start_id;
+  }
+
+  double last_forward_key = 0.0;
+  double last_backward_key = 0.0;
+  bool forward_turn = true;
+  while (true) {
+    const bool is_forward = forward_turn;
+    forward_turn = !forward_turn;
+    SearchScratch& scratch = is_forward ? forward : backward;
+    const SearchState& other = is_forward ? backward.state : forward.state;
+    const CsrGraph& side_graph = is_forward ? *graph : *reverse_graph;
+
+    // Once either side runs out, every path it could reach has already been joined to the other side
+    if (scratch.queue->Empty()) {
+      break;
+    }
+    QueueEntry curr = scratch.queue->Pop();
+    int curr_id = curr.station_id;
+    double curr_time = curr.key;
+
+    // Skip this loop if there's already a quicker path to this station
+    const bool stale = curr_time > scratch.state.GetDistance(curr_id);
+    trace.OnPop(curr_id, curr_time, stale);
+    if (stale) {
+      continue;
+    }
+
+    // Any path not seen yet leaves the forward frontier and enters the backward one, so it takes at least
+    // the two smallest keys: stop once they add up to the best time
+    (is_forward ? last_forward_key : last_backward_key) = curr_time;
+    if (last_forward_key + last_backward_key >= best_time) {
+      break;
+    }
+    ++settled;
+    trace.OnSettle(curr_id, curr_time);
+
+    for (int edge = side_graph.offsets[curr_id]; edge < side_graph.offsets[curr_id + 1]; ++edge) {
+      const int next_id = side_graph.targets[edge];
+      const double new_time = curr_time + side_graph.weights[edge];
+      ++relaxed;
+      const bool improved = new_time < scratch.state.GetDistance(next_id);
+      trace.OnRelax(curr_id, next_id, new_time, improved);
+      if (improved) {
+        scratch.state.SetDistance(next_id, new_time, curr_id);
+        scratch.queue->Push(next_id, new_time);
+        trace.OnPush(next_id, new_time);
+      }
+      // Join the frontiers through this edge if the other side has reached its far end
+      if (other.IsReached(next_id) && new_time + other.GetDistance(next_id) < best_time) {
+        best_time = new_time + other.GetDistance(next_id);
+        meet_from = is_forward ? curr_id : next_id;
+        meet_to = is_forward ? next_id : curr_id;
+      }
+    }
+  }
+
+  if (stats != nullptr) {
+    stats->settled += settled;
+    stats->relaxed += relaxed;
+    stats->AddQueueOperations(forward_before, forward.queue->GetStats());
+    stats->AddQueueOperations(backward_before, backward.queue->GetStats());
+  }
+
+  if (meet_from < 0) {
+    return {std::numeric_limits<double>::infinity(), std::vector<Station>()};
+  }
+  return GetPath(*graph, forward.state, backward.state, meet_from, meet_to);
+}
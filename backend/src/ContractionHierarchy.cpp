@@ -0,0 +1,550 @@
+#include "../include/ContractionHierarchy.h"
+#include "../include/Logger.h"
+#include "../include/ParallelFor.h"
+#include <algorithm>
+#include <chrono>
+#include <functional>
+#include <iomanip>
+#include <limits>
+#include <numeric>
+#include <queue>
+#include <sstream>
+
+namespace {
+
+constexpr double kInfinity = std::numeric_limits<double>::infinity();
+// Witness searches give up after settling this many stations; the shortcut is then added to stay correct
+constexpr int kWitnessSettleLimit = 256;
+
+struct DynamicArc {
+  int target;
+  double weight;
+  int middle;
+};
+
+// Graph that shrinks while stations are contracted and gains shortcuts between their neighbors
+struct DynamicGraph {
+  std::vector<std::vector<DynamicArc>> out;
+  std::vector<std::vector<DynamicArc>> in;  // target is the departure station
+  std::vector<bool> contracted;
+  std::vector<int> contracted_neighbors;
+
+  explicit DynamicGraph(int station_count)
+      : out(station_count), in(station_count), contracted(station_count, false),
+        contracted_neighbors(station_count, 0) {}
+
+  // Adds the arc, or lowers the weight of an existing one between the same stations
+  // Returns true if a new arc was inserted
+  bool AddOrImprove(int from_id, int to_id, double weight, int middle) {
+    for (auto& arc : out[from_id]) {
+      if (arc.target == to_id) {
+        if (weight < arc.weight) {
+          arc.weight = weight;
+          arc.middle = middle;
+          for (auto& reverse : in[to_id]) {
+            if (reverse.target == from_id) {
+              reverse.weight = weight;
+              reverse.middle = middle;
+            }
+          }
+        }
+        return false;
+      }
+    }
+    out[from_id].push_back(DynamicArc{to_id, weight, middle});
+    in[to_id].push_back(DynamicArc{from_id, weight, middle});
+    return true;
+  }
+};
+
+// Bounded Dijkstra among uncontracted stations, used to look for witnesses that make a shortcut unnecessary
+class WitnessSearch {
+  private:
+
+    std::vector<double> distances_;
+    std::vector<int> touched_;
+    std::priority_queue<std::pair<double, int>, std::vector<std::pair<double, int>>,
+                        std::greater<std::pair<double, int>>> queue_;
+
+  public:
+
+    explicit WitnessSearch(int station_count) : distances_(station_count, kInfinity) {}
+
+    // Quickest times from start_id avoiding skip_id, exact up to max_time within the settle limit
+    void Run(const DynamicGraph& graph, int start_id, int skip_id, double max_time) {
+      for (int station_id : touched_) {
+        distances_[station_id] = kInfinity;
+      }
+      touched_.clear();
+      queue_ = {};
+
+      distances_[start_id] = 0.0;
+      touched_.push_back(start_id);
+      queue_.push({0.0, start_id});
+      int settled = 0;
+      while (!queue_.empty() && settled < kWitnessSettleLimit) {
+        auto [time, station_id] = queue_.top();
+        queue_.pop();
+        if (time > distances_[station_id]) {
+          continue;
+        }
+        if (time > max_time) {
+          break;
+        }
+        ++settled;
+        for (const auto& arc : graph.out[station_id]) {
+          if (arc.target == skip_id || graph.contracted[arc.target]) {
+            continue;
+          }
+          const double new_time = time + arc.weight;
+          if (new_time < distances_[arc.target]) {
+            if (distances_[arc.target] == kInfinity) {
+              touched_.push_back(arc.target);
+            }
+            distances_[arc.target] = new_time;
+            queue_.push({new_time, arc.target});
+          }
+        }
+      }
+    }
+
+    double GetDistance(int station_id) const { return distances_[station_id]; }
+};
+
+// Calls add_shortcut(from, to, weight) for every shortcut contracting station_id would need
+template <typename OnShortcut>
+void FindShortcuts(const DynamicGraph& graph, int station_id, WitnessSearch& witness, OnShortcut&& add_shortcut) {
+  double max_out = 0.0;
+  for (const auto& arc : graph.out[station_id]) {
+    if (!graph.contracted[arc.target]) {
+      max_out = std::max(max_out, arc.weight);
+    }
+  }
+
+  for (const auto& in_arc : graph.in[station_id]) {
+    const int from_id = in_arc.target;
+    if (graph.contracted[from_id]) {
+      continue;
+    }
+    witness.Run(graph, from_id, station_id, in_arc.weight + max_out);
+    for (const auto& out_arc : graph.out[station_id]) {
+      const int to_id = out_arc.target;
+      if (to_id == from_id || graph.contracted[to_id]) {
+        continue;
+      }
+      const double via_time = in_arc.weight + out_arc.weight;
+      if (witness.GetDistance(to_id) > via_time) {
+        add_shortcut(from_id, to_id, via_time);
+      }
+    }
+  }
+}
+
+// Importance of a station: shortcuts added minus arcs removed, plus already contracted neighbors
+// so contraction spreads evenly over the network
+int Priority(const DynamicGraph& graph, int station_id, WitnessSearch& witness) {
+  int shortcuts = 0;
+  FindShortcuts(graph, station_id, witness, [&shortcuts](int, int, double) { ++shortcuts; });
+  int removed = 0;
+  for (const auto& arc : graph.out[station_id]) {
+    removed += graph.contracted[arc.target] ? 0 : 1;
+  }
+  for (const auto& arc : graph.in[station_id]) {
+    removed += graph.contracted[arc.target] ? 0 : 1;
+  }
+  return shortcuts - removed + graph.contracted_neighbors[station_id];
+}
+
+}  // namespace
+
+ContractionHierarchy::ContractionHierarchy(const AdjacencyList* adj_list, QueueType queue_type)
+    : adj_list_(adj_list), queue_type_(queue_type), hierarchies_(TimeSlice::kCount), ready_(false) {}
+
+ContractionHierarchy::~ContractionHierarchy() {
+  if (builder_.joinable()) {
+    builder_.join();
+  }
+}
+
+ContractionHierarchy::Hierarchy ContractionHierarchy::Contract(const CsrGraph& graph) {
+  const int station_count = graph.StationCount();
+  Hierarchy hierarchy;
+  hierarchy.rank.assign(station_count, -1);
+
+  // Parallel edges collapse to the quickest one; self loops never help a shortest path
+  DynamicGraph dynamic(station_count);
+  for (int station_id = 0; station_id < station_count; ++station_id) {
+    for (int edge = graph.offsets[station_id]; edge < graph.offsets[station_id + 1]; ++edge) {
+      if (graph.targets[edge] != station_id &&
+          dynamic.AddOrImprove(station_id, graph.targets[edge], graph.weights[edge], -1)) {
+        hierarchy.original_arcs++;
+      }
+    }
+  }
+
+  WitnessSearch witness(station_count);
+  std::priority_queue<std::pair<int, int>, std::vector<std::pair<int, int>>, std::greater<std::pair<int, int>>> order;
+  for (int station_id = 0; station_id < station_count; ++station_id) {
+    order.push({Priority(dynamic, station_id, witness), station_id});
+  }
+
+  std::vector<std::vector<Arc>> up(station_count);
+  std::vector<std::vector<Arc>> down(station_count);
+  int next_rank = 0;
+  while (!order.empty()) {
+    const int station_id = order.top().second;
+    order.pop();
+    if (dynamic.contracted[station_id]) {
+      continue;
+    }
+    // Lazy update: priorities go stale as neighbors are contracted, so recheck before contracting
+    const int priority = Priority(dynamic, station_id, witness);
+    if (!order.empty() && priority > order.top().first) {
+      order.push({priority, station_id});
+      continue;
+    }
+
+    hierarchy.rank[station_id] = next_rank++;
+    // Every remaining neighbor is contracted later, so it ranks higher than this station
+    for (const auto& arc : dynamic.out[station_id]) {
+      if (!dynamic.contracted[arc.target]) {
+        up[station_id].push_back(Arc{arc.target, arc.weight, arc.middle});
+      }
+    }
+    for (const auto& arc : dynamic.in[station_id]) {
+      if (!dynamic.contracted[arc.target]) {
+        down[station_id].push_back(Arc{arc.target, arc.weight, arc.middle});
+      }
+    }
+
+    std::vector<std::pair<std::pair<int, int>, double>> shortcuts;
+    FindShortcuts(dynamic, station_id, witness, [&shortcuts](int from_id, int to_id, double weight) {
+      shortcuts.push_back({{from_id, to_id}, weight});
+    });
+    for (const auto& shortcut : shortcuts) {
+      dynamic.AddOrImprove(shortcut.first.first, shortcut.first.second, shortcut.second, station_id);
+    }
+    hierarchy.shortcuts += shortcuts.size();
+
+    dynamic.contracted[station_id] = true;
+    for (const auto& arc : dynamic.out[station_id]) {
+      dynamic.contracted_neighbors[arc.target]++;
+    }
+    for (const auto& arc : dynamic.in[station_id]) {
+      dynamic.contracted_neighbors[arc.target]++;
+    }
+  }
+
+  // Flatten into CSR form
+  auto flatten = [station_count](const std::vector<std::vector<Arc>>& lists, std::vector<int>& offsets,
+                                 std::vector<Arc>& arcs) {
+    offsets.assign(station_count + 1, 0);
+    for (int station_id = 0; station_id < station_count; ++station_id) {
+      offsets[station_id + 1] = offsets[station_id] + static_cast<int>(lists[station_id].size());
+    }
+    arcs.clear();
+    arcs.reserve(offsets[station_count]);
+    for (const auto& list : lists) {
+      arcs.insert(arcs.end(), list.begin(), list.end());
+    }
+  };
+  flatten(up, hierarchy.up_offsets, hierarchy.up_arcs);
+  flatten(down, hierarchy.down_offsets, hierarchy.down_arcs);
+  return hierarchy;
+}
+
+void ContractionHierarchy::Build(unsigned int thread_count, const std::vector<TimeSlice>& slices) {
+  const auto start_time = std::chrono::steady_clock::now();
+  std::vector<TimeSlice> build_slices = slices.empty() ? adj_list_->GetTimeSlices() : slices;
+  std::vector<std::pair<const CsrGraph*, Hierarchy*>> jobs;
+  for (TimeSlice slice : build_slices) {
+    const CsrGraph* graph = adj_list_->GetCsrGraph(slice);
+    if (graph != nullptr) {
+      jobs.emplace_back(graph, &hierarchies_[slice.Index()]);
+    }
+  }
+
+  ParallelFor(jobs.size(), thread_count, [&jobs](std::size_t job) {
+    *jobs[job].second = Contract(*jobs[job].first);
+  });
+
+  report_ = ContractionHierarchyReport();
+  report_.slices = static_cast<int>(jobs.size());
+  report_.stations = adj_list_->GetStationCount();
+  for (const auto& job : jobs) {
+    report_.original_arcs += job.second->original_arcs;
+    report_.shortcuts += job.second->shortcuts;
+  }
+  report_.build_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start_time).count();
+  ready_.store(true, std::memory_order_release);
+}
+
+void ContractionHierarchy::StartBackgroundBuild(unsigned int thread_count) {
+  builder_ = std::thread([this, thread_count]() {
+    Build(thread_count);
+    // Formatted first so the report reaches the log as one entry
+    std::ostringstream report;
+    PrintReport(report, report_);
+    LOG_INFO(report.str());
+  });
+}
+
+bool ContractionHierarchy::HasSlice(TimeSlice slice) const {
+  return IsReady() && slice.IsValid() && hierarchies_[slice.Index()].IsBuilt();
+}
+
+const ContractionHierarchy::Arc* ContractionHierarchy::FindArc(const std::vector<int>& offsets,
+                                                               const std::vector<Arc>& arcs, int station_id,
+                                                               int target) {
+  for (int arc = offsets[station_id]; arc < offsets[station_id + 1]; ++arc) {
+    if (arcs[arc].target == target) {
+      return &arcs[arc];
+    }
+  }
+  return nullptr;
+}
+
+void ContractionHierarchy::UnpackArc(const Hierarchy& hierarchy, int from_id, const Arc& arc,
+                                     std::vector<int>& station_path, double& total_time) const {
+  if (arc.middle < 0) {
+    station_path.push_back(arc.target);
+    total_time += arc.weight;
+    return;
+  }
+  // The bypassed station was contracted first, so the first half arrives at it from above (a down arc keyed
+  // by the middle station) and the second half leaves it upwards
+  const Arc* first = FindArc(hierarchy.down_offsets, hierarchy.down_arcs, arc.middle, from_id);
+  const Arc* second = FindArc(hierarchy.up_offsets, hierarchy.up_arcs, arc.middle, arc.target);
+  UnpackArc(hierarchy, from_id, Arc{arc.middle, first->weight, first->middle}, station_path, total_time);
+  UnpackArc(hierarchy, arc.middle, *second, station_path, total_time);
+}
+
+std::pair<double, std::vector<Station>> ContractionHierarchy::GetQuickestPath(TimeSlice slice, int start_id,
+                                                                              int end_id, SearchStats* stats) const {
+  if (!HasSlice(slice)) {
+    return {-1, std::vector<Station>()};
+  }
+  const Hierarchy& hierarchy = hierarchies_[slice.Index()];
+  const int station_count = static_cast<int>(hierarchy.rank.size());
+  if (start_id < 0 || end_id < 0 || start_id >= station_count || end_id >= station_count) {
+    return {-1, std::vector<Station>()};
+  }
+
+  // Forward search climbs up arcs from the start, backward search climbs down arcs from the end
+  SearchScratch& forward = GetThreadScratch(queue_type_, 0);
+  SearchScratch& backward = GetThreadScratch(queue_type_, 1);
+  forward.Reset(station_count);
+  backward.Reset(station_count);
+  const QueueStats forward_before = forward.queue->GetStats();
+  const QueueStats backward_before = backward.queue->GetStats();
+  std::uint64_t settled = 0;
+  std::uint64_t relaxed = 0;
+
+  forward.state.SetDistance(start_id, 0.0, -1);
+  forward.queue->Push(start_id, 0.0);
+  backward.state.SetDistance(end_id, 0.0, -1);
+  backward.queue->Push(end_id, 0.0);
+
+  double best_time = kInfinity;
+  int meeting_id = -1;
+  bool forward_done = false;
+  bool backward_done = false;
+  bool forward_turn = true;
+  while (!forward_done || !backward_done) {
+    if (forward_turn ? forward_done : backward_done) {
+      forward_turn = !forward_turn;
+      continue;
+    }
+    SearchScratch& scratch = forward_turn ? forward : backward;
+    const SearchScratch& other = forward_turn ? backward : forward;
+    const std::vector<int>& offsets = forward_turn ? hierarchy.up_offsets : hierarchy.down_offsets;
+    const std::vector<Arc>& arcs = forward_turn ? hierarchy.up_arcs : hierarchy.down_arcs;
+    bool& done = forward_turn ? forward_done : backward_done;
+    forward_turn = !forward_turn;
+
+    if (scratch.queue->Empty()) {
+      done = true;
+      continue;
+    }
+    QueueEntry curr = scratch.queue->Pop();
+    if (curr.key > scratch.state.GetDistance(curr.station_id)) {
+      continue;
+    }
+    // Nothing this side settles from here on can lead to a quicker path
+    if (curr.key >= best_time) {
+      done = true;
+      continue;
+    }
+    ++settled;
+
+    if (other.state.IsReached(curr.station_id)) {
+      const double through_time = curr.key + other.state.GetDistance(curr.station_id);
+      if (through_time < best_time) {
+        best_time = through_time;
+        meeting_id = curr.station_id;
+      }
+    }
+
+    for (int arc = offsets[curr.station_id]; arc < offsets[curr.station_id + 1]; ++arc) {
+      const double new_time = curr.key + arcs[arc].weight;
+      ++relaxed;
+      if (new_time < scratch.state.GetDistance(arcs[arc].target)) {
+        scratch.state.SetDistance(arcs[arc].target, new_time, curr.station_id);
+        scratch.queue->Push(arcs[arc].target, new_time);
+      }
+    }
+  }
+
+  if (stats != nullptr) {
+    stats->settled += settled;
+    stats->relaxed += relaxed;
+    stats->AddQueueOperations(forward_before, forward.queue->GetStats());
+    stats->AddQueueOperations(backward_before, backward.queue->GetStats());
+  }
+
+  if (meeting_id < 0) {
+    return {kInfinity, std::vector<Station>()};
+  }
+
+  // Hierarchy stations from the start up to the meeting station, then down to the end
+  std::vector<int> upward_path;
+  for (int station_id = meeting_id; station_id != -1; station_id = forward.state.GetPredecessor(station_id)) {
+    upward_path.push_back(station_id);
+  }
+  std::reverse(upward_path.begin(), upward_path.end());
+
+  // Unpack each arc into original stations, adding up the original edge weights in path order
+  std::vector<int> station_path{start_id};
+  double total_time = 0.0;
+  for (std::size_t i = 1; i < upward_path.size(); ++i) {
+    const Arc* arc = FindArc(hierarchy.up_offsets, hierarchy.up_arcs, upward_path[i - 1], upward_path[i]);
+    UnpackArc(hierarchy, upward_path[i - 1], *arc, station_path, total_time);
+  }
+  for (int station_id = meeting_id; station_id != end_id;) {
+    const int next_id = backward.state.GetPredecessor(station_id);
+    // The edge station_id -> next_id is stored as a down arc of next_id
+    const Arc* arc = FindArc(hierarchy.down_offsets, hierarchy.down_arcs, next_id, station_id);
+    UnpackArc(hierarchy, station_id, Arc{next_id, arc->weight, arc->middle}, station_path, total_time);
+    station_id = next_id;
+  }
+
+  return std::make_pair(total_time, adj_list_->GetStationPath(station_path));
+}
+
+void ContractionHierarchy::PrintReport(std::ostream& out, const ContractionHierarchyReport& report) {
+  out << "Contraction hierarchies: " << report.slices << " slices x " << report.stations << " stations, "
+      << report.original_arcs << " arcs + " << report.shortcuts << " shortcuts in " << std::fixed
+      << std::setprecision(2) << report.build_seconds << " s" << std::defaultfloat << std::endl;
+}
+
+void ContractionHierarchy::UpwardSearch(const std::vector<int>& offsets, const std::vector<Arc>& arcs, int start_id,
+                                        std::vector<std::pair<int, double>>& settled, SearchStats& stats) const {
+  SearchScratch& scratch = GetThreadScratch(queue_type_);
+  scratch.Reset(static_cast<int>(offsets.size()) - 1);
+  const QueueStats queue_before = scratch.queue->GetStats();
+  settled.clear();
+
+  scratch.state.SetDistance(start_id, 0.0, -1);
+  scratch.queue->Push(start_id, 0.0);
+  while (!scratch.queue->Empty()) {
+    QueueEntry curr = scratch.queue->Pop();
+    if (curr.key > scratch.state.GetDistance(curr.station_id)) {
+      continue;
+    }
+    settled.emplace_back(curr.station_id, curr.key);
+    for (int arc = offsets[curr.station_id]; arc < offsets[curr.station_id + 1]; ++arc) {
+      const double new_time = curr.key + arcs[arc].weight;
+      ++stats.relaxed;
+      if (new_time < scratch.state.GetDistance(arcs[arc].target)) {
+        scratch.state.SetDistance(arcs[arc].target, new_time, curr.station_id);
+        scratch.queue->Push(arcs[arc].target, new_time);
+      }
+    }
+  }
+  stats.settled += settled.size();
+  stats.AddQueueOperations(queue_before, scratch.queue->GetStats());
+}
+
+bool ContractionHierarchy::GetTimeMatrix(TimeSlice slice, const std::vector<int>& sources,
+                                         const std::vector<int>& targets, std::vector<double>& times,
+                                         unsigned int thread_count, SearchStats* stats) const {
+  if (!HasSlice(slice)) {
+    return false;
+  }
+  const Hierarchy& hierarchy = hierarchies_[slice.Index()];
+  const int station_count = static_cast<int>(hierarchy.rank.size());
+  auto is_station = [station_count](int station_id) { return station_id >= 0 && station_id < station_count; };
+  const std::size_t target_count = targets.size();
+  times.assign(sources.size() * target_count, kInfinity);
+  std::vector<SearchStats> target_stats(target_count);
+  std::vector<SearchStats> source_stats(sources.size());
+
+  // Backward searches climb the down arcs from each target and keep the stations they settle
+  std::vector<std::vector<std::pair<int, double>>> target_spaces(target_count);
+  ParallelFor(target_count, thread_count, [&](std::size_t target_index) {
+    if (is_station(targets[target_index])) {
+      UpwardSearch(hierarchy.down_offsets, hierarchy.down_arcs, targets[target_index], target_spaces[target_index],
+                   target_stats[target_index]);
+    }
+  });
+
+  // Buckets in CSR form: entries bucket_offsets[v] to bucket_offsets[v + 1] hold the targets whose search settled v
+  struct BucketEntry {
+    int target_index;
+    double time;
+  };
+  std::vector<std::size_t> bucket_offsets(station_count + 1, 0);
+  for (const auto& space : target_spaces) {
+    for (const auto& entry : space) {
+      ++bucket_offsets[entry.first + 1];
+    }
+  }
+  std::partial_sum(bucket_offsets.begin(), bucket_offsets.end(), bucket_offsets.begin());
+  std::vector<BucketEntry> buckets(bucket_offsets.back());
+  std::vector<std::size_t> next_entry(bucket_offsets.begin(), bucket_offsets.end() - 1);
+  for (std::size_t target_index = 0; target_index < target_count; ++target_index) {
+    for (const auto& entry : target_spaces[target_index]) {
+      buckets[next_entry[entry.first]++] = BucketEntry{static_cast<int>(target_index), entry.second};
+    }
+  }
+  target_spaces.clear();
+
+  // Forward searches climb the up arcs from each source and scan the bucket of every station they settle
+  ParallelFor(sources.size(), thread_count, [&](std::size_t source_index) {
+    double* row = &times[source_index * target_count];
+    if (!is_station(sources[source_index])) {
+      std::fill(row, row + target_count, -1.0);
+      return;
+    }
+    thread_local std::vector<std::pair<int, double>> source_space;
+    UpwardSearch(hierarchy.up_offsets, hierarchy.up_arcs, sources[source_index], source_space,
+                 source_stats[source_index]);
+    for (const auto& entry : source_space) {
+      for (std::size_t bucket = bucket_offsets[entry.first]; bucket < bucket_offsets[entry.first + 1]; ++bucket) {
+        const double through_time = entry.second + buckets[bucket].time;
+        if (through_time < row[buckets[bucket].target_index]) {
+          row[buckets[bucket].target_index] = through_time;
+        }
+      }
+    }
+  });
+
+  // Same sentinel as GetQuickestPath for targets that are not stations
+  for (std::size_t target_index = 0; target_index < target_count; ++target_index) {
+    if (!is_station(targets[target_index])) {
+      for (std::size_t source_index = 0; source_index < sources.size(); ++source_index) {
+        times[source_index * target_count + target_index] = -1;
+      }
+    }
+  }
+
+  if (stats != nullptr) {
+    for (const auto& target_stat : target_stats) {
+      stats->Add(target_stat);
+    }
+    for (const auto& source_stat : source_stats) {
+      stats->Add(source_stat);
+    }
+  }
+  return true;
+}
@@ -1,40 +1,33 @@
 #include "../include/Dijkstra.h"
-#include <limits>
 #include <algorithm>
-#include <functional>
-#include <unordered_set>
-#include <iostream>
+#include <sstream>
+#include "../include/Logger.h"
 
-std::unordered_map<int, std::vector<Edge>>* Dijkstra::GetAdjacencyList() const {
-    return adj_lists_->GetAdjacencyList(composite_key_);
-}
-
-void Dijkstra::relaxEdge(int from_id, int to_id, double edge_weight,
-                        std::unordered_map<int, double>& times,
-                        std::unordered_map<int, int>& predecessors,
-                        std::priority_queue<Node, std::vector<Node>, std::greater<>>& pq) {
+template <typename Trace>
+void Dijkstra::relaxEdge(int from_id, int to_id, double edge_weight, SearchScratch& scratch, Trace& trace) {
   // Code from Graphs 2 Study Guide
   // Calculate the new time to go from from_id to to_id
-  double new_time = times[from_id] + edge_weight;
+  double new_time = scratch.state.GetDistance(from_id) + edge_weight;
 
   // If the new_time is quicker than the quickest found time, update the time
-  if (new_time < times[to_id]) {
-    times[to_id] = new_time;
-    predecessors[to_id] = from_id;
+  const bool improved = new_time < scratch.state.GetDistance(to_id);
+  trace.OnRelax(from_id, to_id, new_time, improved);
+  if (improved) {
+    scratch.state.SetDistance(to_id, new_time, from_id);
 
-    // Add the updated node to priority queue
-    pq.emplace(to_id, new_time);
+    // Add the updated node to priority queue, or lower its key if it is already queued
+    scratch.queue->Push(to_id, new_time);
+    trace.OnPush(to_id, new_time);
   }
 
 }
 
-std::vector<Station> Dijkstra::GetPath(std::unordered_map<int, int> predecessors,
-                                    int start_id, int end_id) const {
+std::vector<Station> Dijkstra::GetPath(const SearchState& state, int start_id, int end_id) const {
 
   std::vector<Station> path;
 
   // If there's no path to the destination, return an empty path
-  if (predecessors.find(end_id) == predecessors.end() && start_id != end_id) {
+  if (!state.IsReached(end_id)) {
     return path;
   }
 
@@ -43,80 +36,221 @@ std::vector<Station> Dijkstra::GetPath(std::unordered_map<int, int> predecessors
   int curr_id = end_id;
   while (curr_id != start_id) {
     station_path.push_back(curr_id);
-    curr_id = predecessors[curr_id];
+    curr_id = state.GetPredecessor(curr_id);
   }
   station_path.push_back(start_id);
 
   // Reverse to get path from start to end
   std::reverse(station_path.begin(), station_path.end());
 
-  // Debug: Print station IDs before filtering
-  std::cout << "DEBUG: Station IDs before filtering: ";
-  for (auto id : station_path) {
-    std::cout << id << " ";
+  // Debug: Log station IDs before filtering
+  if (SUBWAY_LOG_ENABLED(LogLevel::Debug)) {
+    std::ostringstream ids;
+    for (auto id : station_path) {
+      ids << id << " ";
+    }
+    LOG_DEBUG("Dijkstra: Station IDs before filtering: " << ids.str());
   }
-  std::cout << std::endl;
 
   // Convert station IDs to Station objects, ensuring no duplicates by station name
-  std::unordered_set<std::string> seen_names;
-  for (auto station_id : station_path) {
-    const Station* station = adj_lists_->GetStation(station_id);
-    if (station && seen_names.find(station->station_name) == seen_names.end()) {
-      path.push_back(*station);
-      seen_names.insert(station->station_name);
-    }
-  }
+  path = adj_lists_->GetStationPath(station_path);
 
-  // Debug: Print final station names
-  std::cout << "DEBUG: Final station names: ";
-  for (const auto& station : path) {
-    std::cout << station.station_name << " ";
+  // Debug: Log final station names
+  if (SUBWAY_LOG_ENABLED(LogLevel::Debug)) {
+    std::ostringstream names;
+    for (const auto& station : path) {
+      names << station.station_name << " ";
+    }
+    LOG_DEBUG("Dijkstra: Final station names: " << names.str());
   }
-  std::cout << std::endl;
 
   return path;
 }
 
 std::pair<double, std::vector<Station>> Dijkstra::GetQuickestPath(const Station& start_station,
                                                                           const Station& end_station) {
-  // Get the adjacency list for current composite key
-  auto* adj_list = GetAdjacencyList();
+  // Get station IDs and search the stored composite key
+  return GetQuickestPath(slice_, adj_lists_->GetStationId(start_station), adj_lists_->GetStationId(end_station));
+}
 
-  // Get station IDs
-  int start_id = adj_lists_->GetStationId(start_station);
-  int end_id = adj_lists_->GetStationId(end_station);
+std::pair<double, std::vector<Station>> Dijkstra::GetQuickestPath(TimeSlice slice, int start_id, int end_id,
+                                                                  SearchStats* stats) const {
+  NullTrace trace;
+  return Search(slice, start_id, end_id, stats, trace);
+}
+
+std::pair<double, std::vector<Station>> Dijkstra::GetQuickestPath(TimeSlice slice, int start_id, int end_id,
+                                                                  RecordingTrace& trace, SearchStats* stats) const {
+  return Search(slice, start_id, end_id, stats, trace);
+}
+
+template <typename Stop>
+void Dijkstra::SettleFrom(const CsrGraph& graph, int start_id, double bound, SearchScratch& scratch,
+                          SearchStats& stats, Stop&& stop) {
+  scratch.Reset(graph.StationCount());
+  const QueueStats queue_before = scratch.queue->GetStats();
+  NullTrace trace;
+  scratch.state.SetDistance(start_id, 0.0, -1);
+  scratch.queue->Push(start_id, 0.0);
+  while (!scratch.queue->Empty()) {
+    QueueEntry curr = scratch.queue->Pop();
+    if (curr.key > scratch.state.GetDistance(curr.station_id)) {
+      continue;
+    }
+    ++stats.settled;
+    if (stop(curr.station_id)) {
+      break;
+    }
+
+    for (int edge = graph.offsets[curr.station_id]; edge < graph.offsets[curr.station_id + 1]; ++edge) {
+      ++stats.relaxed;
+      // Stations beyond the bound never enter the queue, so a bounded search ends when the bound is used up
+      if (curr.key + graph.weights[edge] <= bound) {
+        relaxEdge(curr.station_id, graph.targets[edge], graph.weights[edge], scratch, trace);
+      }
+    }
+  }
+  stats.AddQueueOperations(queue_before, scratch.queue->GetStats());
+}
+
+void Dijkstra::SearchFrom(const CsrGraph& graph, int start_id, SearchScratch& scratch, SearchStats& stats) {
+  SettleFrom(graph, start_id, kUnbounded, scratch, stats, [](int) { return false; });
+}
+
+void Dijkstra::SearchFrom(const CsrGraph& graph, int start_id, SearchScratch& scratch, SearchStats& stats,
+                          std::vector<int>& settled) {
+  SettleFrom(graph, start_id, kUnbounded, scratch, stats, [&settled](int station_id) {
+    settled.push_back(station_id);
+    return false;
+  });
+}
+
+void Dijkstra::SearchToTargets(const CsrGraph& graph, int start_id, const std::vector<int>& end_ids,
+                               SearchScratch& scratch, SearchStats& stats) {
+  const int station_count = graph.StationCount();
+
+  // Mark the targets so the search knows when it can stop; repeated targets are only counted once
+  thread_local std::vector<char> is_target;
+  if (static_cast<int>(is_target.size()) < station_count) {
+    is_target.resize(station_count, 0);
+  }
+  int remaining_targets = 0;
+  for (int end_id : end_ids) {
+    if (end_id >= 0 && end_id < station_count && !is_target[end_id]) {
+      is_target[end_id] = 1;
+      ++remaining_targets;
+    }
+  }
 
-  // If the stations do not exist, return sentinel value
-  if (start_id == -1 || end_id == -1) {
+  if (remaining_targets == 0) {
+    scratch.Reset(station_count);
+    return;
+  }
+  // Stop once the last target is settled; the stations left in the queue cannot improve any of them
+  SettleFrom(graph, start_id, kUnbounded, scratch, stats, [&remaining_targets](int station_id) {
+    return is_target[station_id] && --remaining_targets == 0;
+  });
+
+  // Clear the marks for the next search on this thread
+  for (int end_id : end_ids) {
+    if (end_id >= 0 && end_id < station_count) {
+      is_target[end_id] = 0;
+    }
+  }
+}
+
+std::vector<std::pair<double, std::vector<Station>>> Dijkstra::GetQuickestPaths(TimeSlice slice, int start_id,
+                                                                                const std::vector<int>& end_ids,
+                                                                                SearchStats* stats) const {
+  std::vector<std::pair<double, std::vector<Station>>> results;
+  results.reserve(end_ids.size());
+
+  // Get the CSR graph for the time slice
+  const CsrGraph* graph = adj_lists_->GetCsrGraph(slice);
+  const int station_count = graph == nullptr ? 0 : graph->StationCount();
+  const bool valid_start = graph != nullptr && start_id >= 0 && start_id < station_count;
+
+  SearchScratch& scratch = GetThreadScratch(queue_type_);
+  if (valid_start) {
+    SearchStats work;
+    SearchToTargets(*graph, start_id, end_ids, scratch, work);
+    if (stats != nullptr) {
+      stats->Add(work);
+    }
+  }
+
+  for (int end_id : end_ids) {
+    if (!valid_start || end_id < 0 || end_id >= station_count) {
+      // Same sentinel as GetQuickestPath for a missing slice or station
+      results.emplace_back(-1, std::vector<Station>());
+      continue;
+    }
+    results.emplace_back(scratch.state.GetDistance(end_id), GetPath(scratch.state, start_id, end_id));
+  }
+  return results;
+}
+
+bool Dijkstra::GetReachableStations(TimeSlice slice, int start_id, double time_budget,
+                                    std::vector<std::pair<int, double>>& reachable, SearchStats* stats) const {
+  reachable.clear();
+  const CsrGraph* graph = adj_lists_->GetCsrGraph(slice);
+  if (graph == nullptr || start_id < 0 || start_id >= graph->StationCount() || !(time_budget >= 0)) {
+    return false;
+  }
+
+  SearchScratch& scratch = GetThreadScratch(queue_type_);
+  SearchStats work;
+  SettleFrom(*graph, start_id, time_budget, scratch, work, [&reachable, &scratch](int station_id) {
+    reachable.emplace_back(station_id, scratch.state.GetDistance(station_id));
+    return false;
+  });
+  if (stats != nullptr) {
+    stats->Add(work);
+  }
+  return true;
+}
+
+template <typename Trace>
+std::pair<double, std::vector<Station>> Dijkstra::Search(TimeSlice slice, int start_id, int end_id,
+                                                         SearchStats* stats, Trace& trace) const {
+  // Get the CSR graph for the time slice
+  const CsrGraph* graph = adj_lists_->GetCsrGraph(slice);
+
+  // If the stations or the time slice do not exist, return sentinel value
+  if (graph == nullptr || start_id < 0 || end_id < 0 ||
+      start_id >= graph->StationCount() || end_id >= graph->StationCount()) {
     return {-1, std::vector<Station>()};
   }
 
   // Initialize data structures for Dijkstra's algorithm
-  std::unordered_map<int, double> times;
-  std::unordered_map<int, int> predecessors;
-  std::priority_queue<Node, std::vector<Node>, std::greater<>> pq;
+  // Resetting the state marks every time as infinity without touching the vectors
+  SearchScratch& scratch = GetThreadScratch(queue_type_);
+  scratch.Reset(graph->StationCount());
+  const QueueStats queue_before = scratch.queue->GetStats();
+  std::uint64_t settled = 0;
+  std::uint64_t relaxed = 0;
 
-  // Initialize all times to infinity
-  for (const auto& pair : *adj_list) {
-    times[pair.first] = std::numeric_limits<double>::infinity();
-  }
   // Set start station time to 0
-  times[start_id] = 0.0;
-  pq.emplace(start_id, 0.0);
+  scratch.state.SetDistance(start_id, 0.0, -1);
+  scratch.queue->Push(start_id, 0.0);
+  trace.OnPush(start_id, 0.0);
 
   // Run Dijkstra search to find the quickest path
   // Algorithm from Dijkstra slides
-  while (!pq.empty()) {
-    Node curr = pq.top();
-    pq.pop();
+  while (!scratch.queue->Empty()) {
+    QueueEntry curr = scratch.queue->Pop();
 
     int curr_id = curr.station_id;
-    double curr_time = curr.travel_time;
+    double curr_time = curr.key;
 
     // Skip this loop if there's already a quicker path to this station
-    if (curr_time > times[curr_id]) {
+    const bool stale = curr_time > scratch.state.GetDistance(curr_id);
+    trace.OnPop(curr_id, curr_time, stale);
+    if (stale) {
       continue;
     }
+    ++settled;
+    trace.OnSettle(curr_id, curr_time);
 
     // Stop searching if found the end station
     if (curr_id == end_id) {
@@ -124,17 +258,18 @@ std::pair<double, std::vector<Station>> Dijkstra::GetQuickestPath(const Station&
     }
 
     // Check all neighbors of current station
-    if (adj_list->find(curr_id) != adj_list->end()) {
-      for (const auto& edge : (*adj_list)[curr_id]) {
-        int to_id = adj_lists_->GetStationId(edge.end_station);
-        double edge_weight = edge.travel_time;
-
-        relaxEdge(curr_id, to_id, edge_weight, times, predecessors, pq);
-      }
+    for (int edge = graph->offsets[curr_id]; edge < graph->offsets[curr_id + 1]; ++edge) {
+      relaxEdge(curr_id, graph->targets[edge], graph->weights[edge], scratch, trace);
+      ++relaxed;
     }
   }
 
+  if (stats != nullptr) {
+    stats->settled += settled;
+    stats->relaxed += relaxed;
+    stats->AddQueueOperations(queue_before, scratch.queue->GetStats());
+  }
+
   // Return the quickest time and the path to get to the end
-  return std::make_pair(times[end_id], GetPath(predecessors, start_id, end_id));
+  return std::make_pair(scratch.state.GetDistance(end_id), GetPath(scratch.state, start_id, end_id));
 }
-
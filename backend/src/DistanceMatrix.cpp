@@ -0,0 +1,45 @@
+#include "../include/DistanceMatrix.h"
+#include "../include/Dijkstra.h"
+#include "../include/ParallelFor.h"
+#include <algorithm>
+
+bool DistanceMatrix::Compute(TimeSlice slice, const std::vector<int>& sources, const std::vector<int>& targets,
+                             MatrixAlgorithm algorithm, std::vector<double>& times, unsigned int thread_count,
+                             SearchStats* stats) const {
+  if (algorithm == MatrixAlgorithm::Buckets) {
+    return HasBuckets(slice) && hierarchy_->GetTimeMatrix(slice, sources, targets, times, thread_count, stats);
+  }
+
+  const CsrGraph* graph = adj_list_->GetCsrGraph(slice);
+  if (graph == nullptr) {
+    return false;
+  }
+  const int station_count = graph->StationCount();
+  const std::size_t target_count = targets.size();
+  times.resize(sources.size() * target_count);
+  std::vector<SearchStats> source_stats(sources.size());
+
+  // Every source writes only its own row, so the rows need no lock
+  ParallelFor(sources.size(), thread_count, [&](std::size_t source_index) {
+    double* row = &times[source_index * target_count];
+    const int start_id = sources[source_index];
+    if (start_id < 0 || start_id >= station_count) {
+      std::fill(row, row + target_count, -1.0);
+      return;
+    }
+    // One search per source for all targets
+    SearchScratch& scratch = GetThreadScratch(queue_type_);
+    Dijkstra::SearchToTargets(*graph, start_id, targets, scratch, source_stats[source_index]);
+    for (std::size_t target_index = 0; target_index < target_count; ++target_index) {
+      const int end_id = targets[target_index];
+      row[target_index] = end_id < 0 || end_id >= station_count ? -1 : scratch.state.GetDistance(end_id);
+    }
+  });
+
+  if (stats != nullptr) {
+    for (const auto& source_stat : source_stats) {
+      stats->Add(source_stat);
+    }
+  }
+  return true;
+}
@@ -0,0 +1,339 @@
+#include <climits>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <system_error>
+#include <unordered_set>
+#include "../include/AdjacencyList.h"
+#include "../include/GraphSnapshot.h"
+#include "../include/MappedFile.h"
+
+namespace graph_snapshot {
+
+std::uint64_t Checksum(const char* data, std::size_t size) {
+  std::uint64_t hash = 14695981039346656037ULL;
+  for (std::size_t i = 0; i < size; ++i) {
+    hash ^= static_cast<unsigned char>(data[i]);
+    hash *= 1099511628211ULL;
+  }
+  return hash;
+}
+
+bool SourceStamp(const std::string& file_path, std::uint64_t& size, std::uint64_t& modified) {
+  std::error_code error;
+  size = std::filesystem::file_size(file_path, error);
+  if (error) {
+    return false;
+  }
+  const auto write_time = std::filesystem::last_write_time(file_path, error);
+  if (error) {
+    return false;
+  }
+  modified = static_cast<std::uint64_t>(write_time.time_since_epoch().count());
+  return true;
+}
+
+}  // namespace graph_snapshot
+
+namespace {
+
+// Sections are padded so every array in a mapped snapshot is 8-byte aligned
+std::size_t Align(std::size_t size) {
+  return (size + 7) & ~static_cast<std::size_t>(7);
+}
+
+template <typename T>
+void AppendSection(std::string& payload, const std::vector<T>& values) {
+  payload.append(reinterpret_cast<const char*>(values.data()), values.size() * sizeof(T));
+  payload.resize(Align(payload.size()), '\0');
+}
+
+}  // namespace
+
+bool AdjacencyList::SaveSnapshot(const std::string& file_path, const std::string& source_path) const {
+  using namespace graph_snapshot;
+
+  std::string strings;
+  auto add_string = [&strings](const std::string& value, std::uint32_t& offset, std::uint32_t& length) {
+    offset = static_cast<std::uint32_t>(strings.size());
+    length = static_cast<std::uint32_t>(value.size());
+    strings += value;
+  };
+
+  // Station table, indexed by station ID
+  std::vector<StationRecord> stations(station_count_);
+  for (int station_id = 0; station_id < station_count_; ++station_id) {
+    const Station& station = id_to_station_[station_id];
+    stations[station_id].latitude = station.coordinates.first;
+    stations[station_id].longitude = station.coordinates.second;
+    add_string(station.station_name, stations[station_id].name_offset, stations[station_id].name_length);
+  }
+
+  // One CSR block per time slice and direction, in slice order so the same graph always produces the same bytes
+  const std::vector<TimeSlice> slices = GetTimeSlices();
+  std::vector<KeyRecord> keys(slices.size());
+  std::vector<std::int32_t> offsets, reverse_offsets;
+  std::vector<std::int32_t> targets, reverse_targets;
+  std::vector<double> weights, reverse_weights;
+  offsets.reserve(slices.size() * (station_count_ + 1));
+  reverse_offsets.reserve(slices.size() * (station_count_ + 1));
+  for (std::size_t key_index = 0; key_index < slices.size(); ++key_index) {
+    const auto composite_key = slices[key_index].ToCompositeKey();
+    KeyRecord& record = keys[key_index];
+    for (int field = 0; field < 3; ++field) {
+      add_string(composite_key[field], record.field_offsets[field], record.field_lengths[field]);
+    }
+    record.first_edge = targets.size();
+
+    const CsrGraph& graph = *GetCsrGraph(slices[key_index]);
+    offsets.insert(offsets.end(), graph.offsets.begin(), graph.offsets.end());
+    targets.insert(targets.end(), graph.targets.begin(), graph.targets.end());
+    weights.insert(weights.end(), graph.weights.begin(), graph.weights.end());
+    // The reverse graph has the same number of edges, so it starts at the same first_edge
+    const CsrGraph& reverse = *GetReverseCsrGraph(slices[key_index]);
+    reverse_offsets.insert(reverse_offsets.end(), reverse.offsets.begin(), reverse.offsets.end());
+    reverse_targets.insert(reverse_targets.end(), reverse.targets.begin(), reverse.targets.end());
+    reverse_weights.insert(reverse_weights.end(), reverse.weights.begin(), reverse.weights.end());
+  }
+
+  std::string payload;
+  AppendSection(payload, stations);
+  AppendSection(payload, keys);
+  AppendSection(payload, offsets);
+  AppendSection(payload, targets);
+  AppendSection(payload, weights);
+  AppendSection(payload, reverse_offsets);
+  AppendSection(payload, reverse_targets);
+  AppendSection(payload, reverse_weights);
+  payload += strings;
+  payload.resize(Align(payload.size()), '\0');
+
+  Header header{};
+  std::memcpy(header.magic, kMagic, sizeof(kMagic));
+  header.version = kVersion;
+  header.endian_marker = kEndianMarker;
+  header.station_count = static_cast<std::uint32_t>(station_count_);
+  header.key_count = static_cast<std::uint32_t>(keys.size());
+  header.edge_count = targets.size();
+  header.string_bytes = strings.size();
+  header.payload_size = payload.size();
+  header.payload_checksum = Checksum(payload.data(), payload.size());
+  if (!source_path.empty() && !SourceStamp(source_path, header.source_size, header.source_modified)) {
+    std::cerr << "Error reading file: " << source_path << std::endl;
+    return false;
+  }
+
+  // Write a new file and rename it over the old one, so a graph still mapping the old snapshot keeps its pages
+  const std::string temporary_path = file_path + ".tmp";
+  {
+    std::ofstream file(temporary_path, std::ios::binary | std::ios::trunc);
+    if (!file.is_open()) {
+      std::cerr << "Error opening file: " << temporary_path << std::endl;
+      return false;
+    }
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file.write(payload.data(), static_cast<std::streamsize>(payload.size()));
+    if (!file.flush()) {
+      std::cerr << "Error writing file: " << temporary_path << std::endl;
+      return false;
+    }
+  }
+  std::error_code error;
+  std::filesystem::rename(temporary_path, file_path, error);
+  if (error) {
+    std::cerr << "Error replacing file " << file_path << ": " << error.message() << std::endl;
+    std::filesystem::remove(temporary_path, error);
+    return false;
+  }
+  return true;
+}
+
+bool AdjacencyList::LoadFromSnapshot(const std::string& file_path, const std::string& source_path) {
+  using namespace graph_snapshot;
+
+  auto file = std::make_shared<const MappedFile>(file_path);
+  if (!file->IsOpen()) {
+    std::cerr << "Error opening file: " << file_path << std::endl;
+    return false;
+  }
+
+  auto reject = [&file_path](const char* reason) {
+    std::cerr << "Invalid snapshot " << file_path << ": " << reason << std::endl;
+    return false;
+  };
+
+  // Validate the header before trusting any of the sizes in it
+  Header header{};
+  if (file->Size() < sizeof(header)) {
+    return reject("file too small");
+  }
+  std::memcpy(&header, file->Data(), sizeof(header));
+  if (std::memcmp(header.magic, kMagic, sizeof(kMagic)) != 0) {
+    return reject("bad magic");
+  }
+  if (header.version != kVersion) {
+    return reject("unsupported version");
+  }
+  if (header.endian_marker != kEndianMarker) {
+    return reject("written with a different byte order");
+  }
+  if (header.payload_size != file->Size() - sizeof(header)) {
+    return reject("truncated");
+  }
+  // A snapshot of an older CSV would keep serving the old travel times. If the CSV cannot be read, the
+  // snapshot is all there is
+  std::uint64_t source_size = 0;
+  std::uint64_t source_modified = 0;
+  if (!source_path.empty() && SourceStamp(source_path, source_size, source_modified) &&
+      (source_size != header.source_size || source_modified != header.source_modified)) {
+    return reject("built from a different version of the CSV");
+  }
+  // CsrGraph indexes stations and edges with int
+  if (header.station_count >= static_cast<std::uint32_t>(INT_MAX)) {
+    return reject("too many stations");
+  }
+
+  const char* payload = file->Data() + sizeof(header);
+  const std::uint64_t station_count = header.station_count;
+  const std::uint64_t offsets_count = static_cast<std::uint64_t>(header.key_count) * (station_count + 1);
+  // Sections follow each other; each one's size is checked against what is left of the payload before it is
+  // added, so counts in a crafted header cannot wrap the products or the sum
+  std::uint64_t section_end = 0;
+  auto next_section = [&header, &section_end](std::uint64_t count, std::uint64_t element_size, std::size_t& pos) {
+    if (section_end > header.payload_size || count > (header.payload_size - section_end) / element_size) {
+      return false;
+    }
+    pos = section_end;
+    section_end += Align(count * element_size);
+    return true;
+  };
+  std::size_t stations_pos, keys_pos, strings_pos;
+  std::size_t offsets_pos[2], targets_pos[2], weights_pos[2];
+  if (!next_section(station_count, sizeof(StationRecord), stations_pos) ||
+      !next_section(header.key_count, sizeof(KeyRecord), keys_pos) ||
+      !next_section(offsets_count, sizeof(std::int32_t), offsets_pos[0]) ||
+      !next_section(header.edge_count, sizeof(std::int32_t), targets_pos[0]) ||
+      !next_section(header.edge_count, sizeof(double), weights_pos[0]) ||
+      !next_section(offsets_count, sizeof(std::int32_t), offsets_pos[1]) ||
+      !next_section(header.edge_count, sizeof(std::int32_t), targets_pos[1]) ||
+      !next_section(header.edge_count, sizeof(double), weights_pos[1]) ||
+      !next_section(header.string_bytes, 1, strings_pos)) {
+    return reject("section sizes exceed payload");
+  }
+  if (Checksum(payload, header.payload_size) != header.payload_checksum) {
+    return reject("checksum mismatch");
+  }
+
+  // The mapping is page aligned and every section is padded to 8 bytes, so the arrays can be read in place
+  const auto* stations = reinterpret_cast<const StationRecord*>(payload + stations_pos);
+  const auto* keys = reinterpret_cast<const KeyRecord*>(payload + keys_pos);
+  const char* strings = payload + strings_pos;
+  const int* offsets[2];
+  const int* targets[2];
+  const double* weights[2];
+  for (int direction = 0; direction < 2; ++direction) {
+    offsets[direction] = reinterpret_cast<const int*>(payload + offsets_pos[direction]);
+    targets[direction] = reinterpret_cast<const int*>(payload + targets_pos[direction]);
+    weights[direction] = reinterpret_cast<const double*>(payload + weights_pos[direction]);
+  }
+
+  auto string_at = [&header, strings](std::uint32_t offset, std::uint32_t length, std::string& out) {
+    if (static_cast<std::uint64_t>(offset) + length > header.string_bytes) {
+      return false;
+    }
+    out.assign(strings + offset, length);
+    return true;
+  };
+
+  // Check every index before touching the current graph, so a bad snapshot leaves it unchanged
+  for (int direction = 0; direction < 2; ++direction) {
+    for (std::uint32_t key_index = 0; key_index < header.key_count; ++key_index) {
+      const int* key_offsets = offsets[direction] + key_index * (station_count + 1);
+      if (key_offsets[0] != 0) {
+        return reject("offsets do not start at 0");
+      }
+      // Offsets start at 0 and never decrease, so none is negative
+      for (std::uint64_t station_id = 0; station_id < station_count; ++station_id) {
+        if (key_offsets[station_id] > key_offsets[station_id + 1]) {
+          return reject("offsets not sorted");
+        }
+      }
+      if (keys[key_index].first_edge > header.edge_count ||
+          static_cast<std::uint64_t>(key_offsets[station_count]) > header.edge_count - keys[key_index].first_edge) {
+        return reject("edge range out of bounds");
+      }
+      if (direction == 1 && key_offsets[station_count] != offsets[0][key_index * (station_count + 1) + station_count]) {
+        return reject("reverse graph has a different edge count");
+      }
+    }
+    for (std::uint64_t edge = 0; edge < header.edge_count; ++edge) {
+      if (targets[direction][edge] < 0 || static_cast<std::uint64_t>(targets[direction][edge]) >= station_count) {
+        return reject("edge target out of range");
+      }
+    }
+  }
+
+  std::vector<Station> loaded_stations(station_count);
+  std::unordered_set<Station, StationHash> unique_stations;
+  for (std::uint64_t station_id = 0; station_id < station_count; ++station_id) {
+    Station& station = loaded_stations[station_id];
+    if (!string_at(stations[station_id].name_offset, stations[station_id].name_length, station.station_name)) {
+      return reject("station name out of range");
+    }
+    station.coordinates = {stations[station_id].latitude, stations[station_id].longitude};
+    // Station IDs are only preserved if AddStation sees every station exactly once
+    if (!unique_stations.insert(station).second) {
+      return reject("duplicate stations");
+    }
+  }
+
+  std::vector<TimeSlice> key_slices(header.key_count);
+  std::vector<char> slice_seen(TimeSlice::kCount, 0);
+  for (std::uint32_t key_index = 0; key_index < header.key_count; ++key_index) {
+    std::array<std::string, 3> composite_key;
+    for (int field = 0; field < 3; ++field) {
+      if (!string_at(keys[key_index].field_offsets[field], keys[key_index].field_lengths[field],
+                     composite_key[field])) {
+        return reject("composite key out of range");
+      }
+    }
+    key_slices[key_index] = TimeSlice::FromCompositeKey(composite_key);
+    if (!key_slices[key_index].IsValid()) {
+      return reject("unknown composite key");
+    }
+    // A second record for the same key would silently replace the first one's graph
+    if (slice_seen[key_slices[key_index].Index()]++) {
+      return reject("duplicate composite key");
+    }
+  }
+
+  // Replace the current graph with the snapshot contents
+  id_to_station_.clear();
+  station_to_id_.clear();
+  name_to_station_.clear();
+  adj_list_.clear();
+  slice_graphs_.assign(TimeSlice::kCount, CsrGraph{});
+  reverse_slice_graphs_.assign(TimeSlice::kCount, CsrGraph{});
+  station_count_ = 0;
+
+  for (const Station& station : loaded_stations) {
+    AddStation(station);
+  }
+
+  // The CSR sections are stored exactly as CsrGraph holds them, so the graphs view the mapping without copying
+  for (std::uint32_t key_index = 0; key_index < header.key_count; ++key_index) {
+    const std::uint64_t first_edge = keys[key_index].first_edge;
+    for (int direction = 0; direction < 2; ++direction) {
+      const int* key_offsets = offsets[direction] + key_index * (station_count + 1);
+      const std::size_t edge_count = static_cast<std::size_t>(key_offsets[station_count]);
+      CsrGraph& graph = (direction == 0 ? slice_graphs_ : reverse_slice_graphs_)[key_slices[key_index].Index()];
+      graph.offsets = CsrArray<int>(key_offsets, station_count + 1);
+      graph.targets = CsrArray<int>(targets[direction] + first_edge, edge_count);
+      graph.weights = CsrArray<double>(weights[direction] + first_edge, edge_count);
+    }
+  }
+  snapshot_ = std::move(file);
+
+  return true;
+}
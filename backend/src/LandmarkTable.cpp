@@ -0,0 +1,122 @@
+#include "../include/LandmarkTable.h"
+#include "../include/Dijkstra.h"
+#include "../include/ParallelFor.h"
+#include "../include/SearchScratch.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace {
+
+constexpr double kInfinity = std::numeric_limits<double>::infinity();
+
+// Quickest times from start_id to every station of graph, infinity where there is no path
+void QuickestTimesFrom(const CsrGraph& graph, int start_id, std::vector<double>& times) {
+  SearchScratch& scratch = GetThreadScratch(QueueType::QuaternaryHeap);
+  SearchStats stats;
+  Dijkstra::SearchFrom(graph, start_id, scratch, stats);
+
+  times.resize(graph.StationCount());
+  for (int station_id = 0; station_id < graph.StationCount(); ++station_id) {
+    times[station_id] = scratch.state.GetDistance(station_id);
+  }
+}
+
+}  // namespace
+
+double LandmarkTable::SliceLandmarks::LowerBound(int from_id, int to_id) const {
+  const std::size_t landmark_count = landmarks.size();
+  const double* from_landmark_v = &from_landmark[from_id * landmark_count];
+  const double* from_landmark_t = &from_landmark[to_id * landmark_count];
+  const double* to_landmark_v = &to_landmark[from_id * landmark_count];
+  const double* to_landmark_t = &to_landmark[to_id * landmark_count];
+
+  double bound = 0.0;
+  for (std::size_t i = 0; i < landmark_count; ++i) {
+    // Bounds that involve an unreachable landmark say nothing useful, so they are skipped
+    if (std::isfinite(from_landmark_v[i]) && std::isfinite(from_landmark_t[i])) {
+      bound = std::max(bound, from_landmark_t[i] - from_landmark_v[i]);
+    }
+    if (std::isfinite(to_landmark_v[i]) && std::isfinite(to_landmark_t[i])) {
+      bound = std::max(bound, to_landmark_v[i] - to_landmark_t[i]);
+    }
+  }
+  return bound;
+}
+
+LandmarkTable::SliceLandmarks LandmarkTable::BuildSlice(const CsrGraph& graph, const CsrGraph& reverse_graph,
+                                                        int landmark_count) {
+  const int station_count = graph.StationCount();
+  landmark_count = std::min(landmark_count, station_count);
+  SliceLandmarks result;
+  result.from_landmark.assign(static_cast<std::size_t>(station_count) * landmark_count, kInfinity);
+  result.to_landmark.assign(static_cast<std::size_t>(station_count) * landmark_count, kInfinity);
+  if (landmark_count == 0) {
+    return result;
+  }
+
+  // Farthest point selection: start from the station farthest from station 0, then keep adding the
+  // station whose round trip to its nearest chosen landmark is longest, so landmarks sit on the network's edges
+  std::vector<double> times;
+  QuickestTimesFrom(graph, 0, times);
+  int next_landmark = 0;
+  for (int station_id = 0; station_id < station_count; ++station_id) {
+    if (std::isfinite(times[station_id]) && times[station_id] > times[next_landmark]) {
+      next_landmark = station_id;
+    }
+  }
+
+  std::vector<double> nearest_round_trip(station_count, kInfinity);
+  std::vector<double> from_times;
+  std::vector<double> to_times;
+  for (int i = 0; i < landmark_count; ++i) {
+    const int landmark = next_landmark;
+    result.landmarks.push_back(landmark);
+    QuickestTimesFrom(graph, landmark, from_times);
+    QuickestTimesFrom(reverse_graph, landmark, to_times);
+    for (int station_id = 0; station_id < station_count; ++station_id) {
+      result.from_landmark[static_cast<std::size_t>(station_id) * landmark_count + i] = from_times[station_id];
+      result.to_landmark[static_cast<std::size_t>(station_id) * landmark_count + i] = to_times[station_id];
+      nearest_round_trip[station_id] =
+          std::min(nearest_round_trip[station_id], from_times[station_id] + to_times[station_id]);
+    }
+    nearest_round_trip[landmark] = -1.0;
+
+    // Stations no landmark reaches either way count as farthest of all
+    for (int station_id = 0; station_id < station_count; ++station_id) {
+      if (nearest_round_trip[station_id] > nearest_round_trip[next_landmark] ||
+          nearest_round_trip[next_landmark] < 0) {
+        next_landmark = station_id;
+      }
+    }
+  }
+  return result;
+}
+
+void LandmarkTable::Build(int landmark_count, unsigned int thread_count) {
+  landmark_count_ = landmark_count;
+  slices_.assign(TimeSlice::kCount, SliceLandmarks());
+  const std::vector<TimeSlice> slices = adj_list_->GetTimeSlices();
+  ParallelFor(slices.size(), thread_count, [&](std::size_t i) {
+    const TimeSlice slice = slices[i];
+    slices_[slice.Index()] =
+        BuildSlice(*adj_list_->GetCsrGraph(slice), *adj_list_->GetReverseCsrGraph(slice), landmark_count);
+  });
+}
+
+const LandmarkTable::SliceLandmarks* LandmarkTable::GetSlice(TimeSlice slice) const {
+  if (slice.IsValid() && static_cast<std::size_t>(slice.Index()) < slices_.size() &&
+      !slices_[slice.Index()].landmarks.empty()) {
+    return &slices_[slice.Index()];
+  }
+  return nullptr;
+}
+
+std::size_t LandmarkTable::MemoryBytes() const {
+  std::size_t bytes = 0;
+  for (const auto& slice : slices_) {
+    bytes += (slice.from_landmark.size() + slice.to_landmark.size()) * sizeof(double) +
+             slice.landmarks.size() * sizeof(int);
+  }
+  return bytes;
+}
@@ -0,0 +1,130 @@
+#include "../include/LatencyHistogram.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace {
+
+// Position of the highest set bit, value must not be 0
+int Magnitude(std::uint64_t value) {
+  int magnitude = 0;
+  while (value >>= 1) {
+    ++magnitude;
+  }
+  return magnitude;
+}
+
+}  // namespace
+
+LatencyHistogram::LatencyHistogram() : count_(0), sum_(0), min_(std::numeric_limits<std::uint64_t>::max()), max_(0) {
+  for (auto& bucket : buckets_) {
+    bucket.store(0, std::memory_order_relaxed);
+  }
+}
+
+std::size_t LatencyHistogram::BucketIndex(std::uint64_t value) {
+  if (value < kSubBucketCount) {
+    return static_cast<std::size_t>(value);
+  }
+  // Shift so the value keeps kSubBucketBits significant bits, which puts it in [kSubBucketHalf, kSubBucketCount)
+  const int shift = Magnitude(value) - kSubBucketBits + 1;
+  return static_cast<std::size_t>(shift) * kSubBucketHalf + static_cast<std::size_t>(value >> shift);
+}
+
+std::uint64_t LatencyHistogram::BucketLowest(std::size_t index) {
+  if (index < kSubBucketCount) {
+    return index;
+  }
+  const std::size_t shift = index / kSubBucketHalf - 1;
+  return static_cast<std::uint64_t>(index - shift * kSubBucketHalf) << shift;
+}
+
+std::uint64_t LatencyHistogram::BucketHighest(std::size_t index) {
+  if (index < kSubBucketCount) {
+    return index;
+  }
+  const std::size_t shift = index / kSubBucketHalf - 1;
+  return BucketLowest(index) + (std::uint64_t(1) << shift) - 1;
+}
+
+void LatencyHistogram::Record(std::uint64_t value) {
+  value = std::min(value, kMaxValue);
+  buckets_[BucketIndex(value)].fetch_add(1, std::memory_order_relaxed);
+  count_.fetch_add(1, std::memory_order_relaxed);
+  sum_.fetch_add(value, std::memory_order_relaxed);
+
+  std::uint64_t current = min_.load(std::memory_order_relaxed);
+  while (value < current && !min_.compare_exchange_weak(current, value, std::memory_order_relaxed)) {
+  }
+  current = max_.load(std::memory_order_relaxed);
+  while (value > current && !max_.compare_exchange_weak(current, value, std::memory_order_relaxed)) {
+  }
+}
+
+void LatencyHistogram::Merge(const LatencyHistogram& other) {
+  for (std::size_t i = 0; i < kBucketCount; ++i) {
+    const std::uint64_t bucket_count = other.buckets_[i].load(std::memory_order_relaxed);
+    if (bucket_count > 0) {
+      buckets_[i].fetch_add(bucket_count, std::memory_order_relaxed);
+    }
+  }
+  count_.fetch_add(other.count_.load(std::memory_order_relaxed), std::memory_order_relaxed);
+  sum_.fetch_add(other.sum_.load(std::memory_order_relaxed), std::memory_order_relaxed);
+
+  const std::uint64_t other_min = other.min_.load(std::memory_order_relaxed);
+  std::uint64_t current = min_.load(std::memory_order_relaxed);
+  while (other_min < current && !min_.compare_exchange_weak(current, other_min, std::memory_order_relaxed)) {
+  }
+  const std::uint64_t other_max = other.max_.load(std::memory_order_relaxed);
+  current = max_.load(std::memory_order_relaxed);
+  while (other_max > current && !max_.compare_exchange_weak(current, other_max, std::memory_order_relaxed)) {
+  }
+}
+
+void LatencyHistogram::Reset() {
+  for (auto& bucket : buckets_) {
+    bucket.store(0, std::memory_order_relaxed);
+  }
+  count_.store(0, std::memory_order_relaxed);
+  sum_.store(0, std::memory_order_relaxed);
+  min_.store(std::numeric_limits<std::uint64_t>::max(), std::memory_order_relaxed);
+  max_.store(0, std::memory_order_relaxed);
+}
+
+std::uint64_t LatencyHistogram::GetMin() const {
+  const std::uint64_t min = min_.load(std::memory_order_relaxed);
+  return min == std::numeric_limits<std::uint64_t>::max() ? 0 : min;
+}
+
+double LatencyHistogram::GetMean() const {
+  const std::uint64_t count = GetCount();
+  return count == 0 ? 0.0 : static_cast<double>(GetSum()) / count;
+}
+
+std::uint64_t LatencyHistogram::ValueAtPercentile(double percentile) const {
+  const std::uint64_t count = GetCount();
+  if (count == 0) {
+    return 0;
+  }
+  // Rank of the value at the percentile, counting from 1
+  percentile = std::min(100.0, std::max(0.0, percentile));
+  const std::uint64_t rank =
+      std::max<std::uint64_t>(1, static_cast<std::uint64_t>(std::ceil(percentile / 100.0 * count)));
+  std::uint64_t seen = 0;
+  for (std::size_t i = 0; i < kBucketCount; ++i) {
+    seen += buckets_[i].load(std::memory_order_relaxed);
+    if (seen >= rank) {
+      return std::min(BucketHighest(i), GetMax());
+    }
+  }
+  return GetMax();
+}
+
+std::uint64_t LatencyHistogram::CountAtOrBelow(std::uint64_t value) const {
+  const std::size_t last = BucketIndex(std::min(value, kMaxValue));
+  std::uint64_t count = 0;
+  for (std::size_t i = 0; i <= last; ++i) {
+    count += buckets_[i].load(std::memory_order_relaxed);
+  }
+  return count;
+}
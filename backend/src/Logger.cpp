@@ -0,0 +1,150 @@
+#include "../include/Logger.h"
+#include <ctime>
+
+namespace {
+
+// Same reentrant conversion as the request handlers use
+std::tm LocalTime(std::time_t time) {
+  std::tm result{};
+#ifdef _WIN32
+  localtime_s(&result, &time);
+#else
+  localtime_r(&time, &result);
+#endif
+  return result;
+}
+
+}  // namespace
+
+const char* LogLevelName(LogLevel level) {
+  switch (level) {
+    case LogLevel::Debug: return "debug";
+    case LogLevel::Info: return "info";
+    case LogLevel::Warning: return "warning";
+    case LogLevel::Error: return "error";
+    default: return "off";
+  }
+}
+
+bool ParseLogLevel(std::string_view text, LogLevel& level) {
+  for (LogLevel candidate : {LogLevel::Debug, LogLevel::Info, LogLevel::Warning, LogLevel::Error, LogLevel::Off}) {
+    if (text == LogLevelName(candidate)) {
+      level = candidate;
+      return true;
+    }
+  }
+  return false;
+}
+
+Logger::Logger()
+    : ring_(std::make_unique<std::array<Record, kCapacity>>()),
+      enqueue_position_(0),
+      dequeue_position_(0),
+      level_(static_cast<int>(LogLevel::Info)),
+      dropped_(0),
+      written_(0),
+      output_(stdout),
+      stopping_(false) {
+  // A slot whose sequence equals the enqueue position is free; the writer hands it back one lap later
+  for (std::size_t i = 0; i < kCapacity; ++i) {
+    (*ring_)[i].sequence.store(i, std::memory_order_relaxed);
+  }
+  writer_ = std::thread(&Logger::WriterLoop, this);
+}
+
+Logger::~Logger() {
+  stopping_.store(true, std::memory_order_release);
+  wake_.notify_one();
+  writer_.join();
+}
+
+Logger& Logger::Instance() {
+  static Logger logger;
+  return logger;
+}
+
+void Logger::SetOutput(std::FILE* output) {
+  Flush();
+  output_.store(output, std::memory_order_release);
+}
+
+bool Logger::Log(LogLevel level, std::string text) {
+  // Bounded multi-producer queue: claim a slot by advancing the enqueue position, fill it, then publish it
+  // by moving its sequence on. The writer is the only consumer
+  std::size_t position = enqueue_position_.load(std::memory_order_relaxed);
+  Record* record;
+  while (true) {
+    record = &(*ring_)[position & (kCapacity - 1)];
+    const std::size_t sequence = record->sequence.load(std::memory_order_acquire);
+    const auto difference = static_cast<std::intptr_t>(sequence) - static_cast<std::intptr_t>(position);
+    if (difference == 0) {
+      if (enqueue_position_.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+        break;
+      }
+    } else if (difference < 0) {
+      // The writer has not freed this slot yet: the buffer is full
+      dropped_.fetch_add(1, std::memory_order_relaxed);
+      return false;
+    } else {
+      position = enqueue_position_.load(std::memory_order_relaxed);
+    }
+  }
+  // Every line gets its own newline, so one at the end of a multi-line message such as a report is dropped
+  if (!text.empty() && text.back() == '\n') {
+    text.pop_back();
+  }
+  record->level = level;
+  record->time = std::chrono::system_clock::now();
+  record->text = std::move(text);
+  record->sequence.store(position + 1, std::memory_order_release);
+  // No notify: waking a waiting writer is a futex call on the caller's thread, and the writer polls anyway
+  return true;
+}
+
+std::size_t Logger::Drain() {
+  std::FILE* output = output_.load(std::memory_order_acquire);
+  std::size_t count = 0;
+  while (true) {
+    Record& record = (*ring_)[dequeue_position_ & (kCapacity - 1)];
+    if (record.sequence.load(std::memory_order_acquire) != dequeue_position_ + 1) {
+      break;
+    }
+    const auto since_epoch = record.time.time_since_epoch();
+    const std::tm local_time = LocalTime(std::chrono::system_clock::to_time_t(record.time));
+    const long milliseconds =
+        static_cast<long>(std::chrono::duration_cast<std::chrono::milliseconds>(since_epoch).count() % 1000);
+    char stamp[32];
+    std::strftime(stamp, sizeof(stamp), "%Y-%m-%d %H:%M:%S", &local_time);
+    std::fprintf(output, "%s.%03ld %-7s %s\n", stamp, milliseconds, LogLevelName(record.level),
+                 record.text.c_str());
+
+    record.text.clear();
+    record.sequence.store(dequeue_position_ + kCapacity, std::memory_order_release);
+    ++dequeue_position_;
+    ++count;
+  }
+  if (count > 0) {
+    std::fflush(output);
+    written_.fetch_add(count, std::memory_order_release);
+  }
+  return count;
+}
+
+void Logger::WriterLoop() {
+  while (!stopping_.load(std::memory_order_acquire)) {
+    if (Drain() == 0) {
+      // Producers never notify, only Flush and shutdown do, so the timeout bounds how long a line waits
+      std::unique_lock<std::mutex> lock(wake_mutex_);
+      wake_.wait_for(lock, std::chrono::milliseconds(50));
+    }
+  }
+  Drain();
+}
+
+void Logger::Flush() {
+  const std::size_t target = enqueue_position_.load(std::memory_order_acquire);
+  while (written_.load(std::memory_order_acquire) < target) {
+    wake_.notify_one();
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+}
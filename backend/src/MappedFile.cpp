@@ -0,0 +1,120 @@
+#include "../include/MappedFile.h"
+
+#ifdef _WIN32
+#define NOMINMAX
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#ifdef _WIN32
+
+MappedFile::MappedFile(const std::string& file_path)
+    : data_(nullptr), size_(0), is_open_(false),
+      file_handle_(INVALID_HANDLE_VALUE), mapping_handle_(nullptr) {
+  file_handle_ = CreateFileA(file_path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+                             OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+  if (file_handle_ == INVALID_HANDLE_VALUE) {
+    return;
+  }
+
+  LARGE_INTEGER file_size;
+  if (!GetFileSizeEx(file_handle_, &file_size)) {
+    Close();
+    return;
+  }
+  size_ = static_cast<std::size_t>(file_size.QuadPart);
+
+  // Windows refuses to map empty files, but an empty file is still a valid (empty) view
+  if (size_ == 0) {
+    is_open_ = true;
+    return;
+  }
+
+  mapping_handle_ = CreateFileMappingA(file_handle_, nullptr, PAGE_READONLY, 0, 0, nullptr);
+  if (mapping_handle_ == nullptr) {
+    Close();
+    return;
+  }
+
+  data_ = static_cast<const char*>(MapViewOfFile(mapping_handle_, FILE_MAP_READ, 0, 0, 0));
+  if (data_ == nullptr) {
+    Close();
+    return;
+  }
+  is_open_ = true;
+}
+
+void MappedFile::Close() {
+  if (data_ != nullptr) {
+    UnmapViewOfFile(data_);
+  }
+  if (mapping_handle_ != nullptr) {
+    CloseHandle(mapping_handle_);
+  }
+  if (file_handle_ != INVALID_HANDLE_VALUE) {
+    CloseHandle(file_handle_);
+  }
+  data_ = nullptr;
+  size_ = 0;
+  is_open_ = false;
+  mapping_handle_ = nullptr;
+  file_handle_ = INVALID_HANDLE_VALUE;
+}
+
+#else
+
+MappedFile::MappedFile(const std::string& file_path)
+    : data_(nullptr), size_(0), is_open_(false), file_descriptor_(-1) {
+  file_descriptor_ = open(file_path.c_str(), O_RDONLY);
+  if (file_descriptor_ == -1) {
+    return;
+  }
+
+  struct stat file_info{};
+  if (fstat(file_descriptor_, &file_info) == -1) {
+    Close();
+    return;
+  }
+  size_ = static_cast<std::size_t>(file_info.st_size);
+
+  // mmap rejects zero-length mappings, but an empty file is still a valid (empty) view
+  if (size_ == 0) {
+    is_open_ = true;
+    return;
+  }
+
+  void* mapping = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, file_descriptor_, 0);
+  if (mapping == MAP_FAILED) {
+    Close();
+    return;
+  }
+  data_ = static_cast<const char*>(mapping);
+
+  // The whole file is read front to back, so let the kernel read ahead aggressively
+  madvise(mapping, size_, MADV_SEQUENTIAL);
+  is_open_ = true;
+}
+
+void MappedFile::Close() {
+  if (data_ != nullptr) {
+    munmap(const_cast<char*>(data_), size_);
+  }
+  if (file_descriptor_ != -1) {
+    close(file_descriptor_);
+  }
+  data_ = nullptr;
+  size_ = 0;
+  is_open_ = false;
+  file_descriptor_ = -1;
+}
+
+#endif
+
+MappedFile::~MappedFile() {
+  Close();
+}
@@ -0,0 +1,59 @@
+#include "../include/ParallelFor.h"
+
+WorkerPool::~WorkerPool() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stopping_ = true;
+  }
+  task_ready_.notify_all();
+  for (auto& thread : threads_) {
+    thread.join();
+  }
+}
+
+void WorkerPool::Submit(const void* owner, std::function<void()> task) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  tasks_.emplace_back(owner, std::move(task));
+  // Every idle thread may already be promised to an earlier task
+  if (idle_ < tasks_.size()) {
+    threads_.emplace_back(&WorkerPool::WorkerLoop, this);
+  } else {
+    task_ready_.notify_one();
+  }
+}
+
+void WorkerPool::Withdraw(const void* owner) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  tasks_.erase(std::remove_if(tasks_.begin(), tasks_.end(),
+                              [owner](const std::pair<const void*, std::function<void()>>& task) {
+                                return task.first == owner;
+                              }),
+               tasks_.end());
+}
+
+std::size_t WorkerPool::ThreadCount() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return threads_.size();
+}
+
+WorkerPool& WorkerPool::Shared() {
+  static WorkerPool* pool = new WorkerPool();
+  return *pool;
+}
+
+void WorkerPool::WorkerLoop() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (true) {
+    ++idle_;
+    task_ready_.wait(lock, [this]() { return stopping_ || !tasks_.empty(); });
+    --idle_;
+    if (tasks_.empty()) {
+      return;
+    }
+    std::function<void()> task = std::move(tasks_.front().second);
+    tasks_.pop_front();
+    lock.unlock();
+    task();
+    lock.lock();
+  }
+}
@@ -0,0 +1,211 @@
+#include "../include/PriorityQueue.h"
+#include <algorithm>
+#include <cstring>
+
+namespace {
+
+// Orders a std heap so the smallest key is on top
+bool GreaterKey(const QueueEntry& lhs, const QueueEntry& rhs) {
+  return lhs.key > rhs.key;
+}
+
+// Returns the index of the highest set bit of a non-zero value
+int HighestBit(std::uint64_t value) {
+#if defined(__GNUC__) || defined(__clang__)
+  return 63 - __builtin_clzll(value);
+#else
+  int bit = 0;
+  while (value >>= 1) {
+    ++bit;
+  }
+  return bit;
+#endif
+}
+
+}  // namespace
+
+// Binary heap
+
+void BinaryHeapQueue::Reset(int /*station_count*/) {
+  heap_.clear();
+}
+
+void BinaryHeapQueue::Push(int station_id, double key) {
+  heap_.push_back({station_id, key});
+  std::push_heap(heap_.begin(), heap_.end(), GreaterKey);
+  ++stats_.pushes;
+  RecordSize(heap_.size());
+}
+
+QueueEntry BinaryHeapQueue::Pop() {
+  std::pop_heap(heap_.begin(), heap_.end(), GreaterKey);
+  const QueueEntry entry = heap_.back();
+  heap_.pop_back();
+  ++stats_.pops;
+  return entry;
+}
+
+// Indexed 4-ary heap
+
+void QuaternaryHeapQueue::Reset(int station_count) {
+  // Only the stations still queued from the last search have a position to clear
+  for (const QueueEntry& entry : heap_) {
+    positions_[entry.station_id] = -1;
+  }
+  heap_.clear();
+  if (static_cast<int>(positions_.size()) < station_count) {
+    positions_.resize(station_count, -1);
+  }
+}
+
+void QuaternaryHeapQueue::Place(std::size_t index, const QueueEntry& entry) {
+  heap_[index] = entry;
+  positions_[entry.station_id] = static_cast<int>(index);
+}
+
+void QuaternaryHeapQueue::SiftUp(std::size_t index) {
+  const QueueEntry entry = heap_[index];
+  while (index > 0) {
+    const std::size_t parent = (index - 1) / 4;
+    if (heap_[parent].key <= entry.key) {
+      break;
+    }
+    Place(index, heap_[parent]);
+    index = parent;
+  }
+  Place(index, entry);
+}
+
+void QuaternaryHeapQueue::SiftDown(std::size_t index) {
+  const QueueEntry entry = heap_[index];
+  const std::size_t size = heap_.size();
+  while (true) {
+    const std::size_t first_child = index * 4 + 1;
+    if (first_child >= size) {
+      break;
+    }
+    // Find the smallest of up to four children
+    std::size_t smallest = first_child;
+    const std::size_t last_child = std::min(first_child + 4, size);
+    for (std::size_t child = first_child + 1; child < last_child; ++child) {
+      if (heap_[child].key < heap_[smallest].key) {
+        smallest = child;
+      }
+    }
+    if (entry.key <= heap_[smallest].key) {
+      break;
+    }
+    Place(index, heap_[smallest]);
+    index = smallest;
+  }
+  Place(index, entry);
+}
+
+void QuaternaryHeapQueue::Push(int station_id, double key) {
+  const int position = positions_[station_id];
+  if (position != -1) {
+    // Already queued: decrease its key in place rather than adding a second entry
+    if (key < heap_[position].key) {
+      heap_[position].key = key;
+      SiftUp(static_cast<std::size_t>(position));
+      ++stats_.decrease_keys;
+    }
+    return;
+  }
+
+  heap_.push_back({station_id, key});
+  positions_[station_id] = static_cast<int>(heap_.size() - 1);
+  SiftUp(heap_.size() - 1);
+  ++stats_.pushes;
+  RecordSize(heap_.size());
+}
+
+QueueEntry QuaternaryHeapQueue::Pop() {
+  const QueueEntry top = heap_.front();
+  positions_[top.station_id] = -1;
+
+  const QueueEntry last = heap_.back();
+  heap_.pop_back();
+  if (!heap_.empty()) {
+    Place(0, last);
+    SiftDown(0);
+  }
+  ++stats_.pops;
+  return top;
+}
+
+// Radix heap
+
+int RadixHeapQueue::BucketFor(std::uint64_t bits) const {
+  return bits == last_bits_ ? 0 : HighestBit(bits ^ last_bits_) + 1;
+}
+
+void RadixHeapQueue::Reset(int /*station_count*/) {
+  for (auto& bucket : buckets_) {
+    bucket.clear();
+  }
+  last_bits_ = 0;
+  size_ = 0;
+}
+
+void RadixHeapQueue::Push(int station_id, double key) {
+  // Non-negative doubles compare the same way as their bit patterns read as unsigned integers
+  const double clamped_key = key > 0.0 ? key : 0.0;
+  std::uint64_t bits = 0;
+  std::memcpy(&bits, &clamped_key, sizeof(bits));
+  bits = std::max(bits, last_bits_);
+
+  buckets_[BucketFor(bits)].push_back({bits, {station_id, key}});
+  ++size_;
+  ++stats_.pushes;
+  RecordSize(size_);
+}
+
+QueueEntry RadixHeapQueue::Pop() {
+  if (buckets_[0].empty()) {
+    // Move the minimum of the first non-empty bucket into last_bits_ and redistribute that bucket.
+    // Every entry in it now differs from last_bits_ in a lower bit, so each one lands in a lower bucket
+    std::size_t bucket = 1;
+    while (buckets_[bucket].empty()) {
+      ++bucket;
+    }
+    auto& source = buckets_[bucket];
+    last_bits_ = std::min_element(source.begin(), source.end(),
+                                  [](const RadixEntry& lhs, const RadixEntry& rhs) { return lhs.bits < rhs.bits; })
+                     ->bits;
+    for (const RadixEntry& radix_entry : source) {
+      buckets_[BucketFor(radix_entry.bits)].push_back(radix_entry);
+    }
+    source.clear();
+  }
+
+  const QueueEntry entry = buckets_[0].back().entry;
+  buckets_[0].pop_back();
+  --size_;
+  ++stats_.pops;
+  return entry;
+}
+
+std::unique_ptr<MinQueue> MakeMinQueue(QueueType type) {
+  switch (type) {
+    case QueueType::BinaryHeap:
+      return std::make_unique<BinaryHeapQueue>();
+    case QueueType::QuaternaryHeap:
+      return std::make_unique<QuaternaryHeapQueue>();
+    case QueueType::RadixHeap:
+      return std::make_unique<RadixHeapQueue>();
+  }
+  return std::make_unique<BinaryHeapQueue>();
+}
+
+const char* QueueTypeName(QueueType type) {
+  switch (type) {
+    case QueueType::BinaryHeap:
+      return "binary_heap";
+    case QueueType::QuaternaryHeap:
+      return "quaternary_heap";
+    case QueueType::RadixHeap:
+      return "radix_heap";
+  }
+  return "unknown";
+}
@@ -0,0 +1,136 @@
+#include "../include/RouteCache.h"
+
+namespace {
+
+// Station IDs get 27 bits each, leaving the high bits for the slice index
+constexpr int kStationBits = 27;
+
+// Mixes key bits so neighbouring station IDs land on different shards
+std::uint64_t MixKey(std::uint64_t key) {
+  key ^= key >> 33;
+  key *= 0xff51afd7ed558ccdULL;
+  key ^= key >> 33;
+  return key;
+}
+
+}  // namespace
+
+RouteCache::RouteCache(std::size_t capacity_bytes, std::size_t shard_count)
+    : shard_capacity_bytes_(0), generation_(0) {
+  std::size_t shards = 1;
+  while (shards < shard_count) {
+    shards <<= 1;
+  }
+  for (std::size_t i = 0; i < shards; ++i) {
+    shards_.push_back(std::make_unique<Shard>());
+  }
+  shard_capacity_bytes_ = capacity_bytes / shards;
+}
+
+std::uint64_t RouteCache::MakeKey(TimeSlice slice, int start_id, int end_id) {
+  return (static_cast<std::uint64_t>(slice.Index()) << (2 * kStationBits)) |
+         (static_cast<std::uint64_t>(start_id) << kStationBits) | static_cast<std::uint64_t>(end_id);
+}
+
+RouteCache::Shard& RouteCache::ShardFor(std::uint64_t key) {
+  return *shards_[MixKey(key) & (shards_.size() - 1)];
+}
+
+std::size_t RouteCache::EntryBytes(const CachedRoute& route) {
+  // List node (entry plus two links), index node, and the shared_ptr control block holding the route
+  std::size_t bytes = sizeof(Entry) + 2 * sizeof(void*) + sizeof(std::uint64_t) + 3 * sizeof(void*) +
+                      sizeof(CachedRoute) + 2 * sizeof(long);
+  bytes += route.route.capacity() * sizeof(std::string);
+  for (const auto& name : route.route) {
+    // Short names live inside the string object; longer ones own a heap buffer
+    if (name.capacity() >= sizeof(std::string)) {
+      bytes += name.capacity() + 1;
+    }
+  }
+  return bytes;
+}
+
+void RouteCache::EvictOverBudget(Shard& shard) {
+  while (shard.bytes > shard_capacity_bytes_ && !shard.lru.empty()) {
+    const Entry& oldest = shard.lru.back();
+    shard.bytes -= oldest.bytes;
+    shard.index.erase(oldest.key);
+    shard.lru.pop_back();
+    shard.evictions++;
+  }
+}
+
+std::shared_ptr<const CachedRoute> RouteCache::Get(std::uint64_t key) {
+  if (!IsEnabled()) {
+    return nullptr;
+  }
+  Shard& shard = ShardFor(key);
+  std::lock_guard<std::mutex> lock(shard.mutex);
+  auto it = shard.index.find(key);
+  if (it == shard.index.end()) {
+    shard.misses++;
+    return nullptr;
+  }
+  // Move to the front so it is evicted last
+  shard.lru.splice(shard.lru.begin(), shard.lru, it->second);
+  shard.hits++;
+  return it->second->value;
+}
+
+void RouteCache::Put(std::uint64_t key, CachedRoute route, std::uint64_t generation) {
+  if (!IsEnabled()) {
+    return;
+  }
+  std::size_t bytes = EntryBytes(route);
+  if (bytes > shard_capacity_bytes_) {
+    return;
+  }
+  auto value = std::make_shared<const CachedRoute>(std::move(route));
+
+  Shard& shard = ShardFor(key);
+  std::lock_guard<std::mutex> lock(shard.mutex);
+  // Invalidate bumps the generation before clearing shards, so a stale result either sees the new
+  // generation here or is inserted before its shard is cleared
+  if (generation != Generation()) {
+    return;
+  }
+
+  auto it = shard.index.find(key);
+  if (it != shard.index.end()) {
+    shard.bytes -= it->second->bytes;
+    it->second->value = std::move(value);
+    it->second->bytes = bytes;
+    shard.lru.splice(shard.lru.begin(), shard.lru, it->second);
+  } else {
+    shard.lru.push_front(Entry{key, std::move(value), bytes});
+    shard.index.emplace(key, shard.lru.begin());
+  }
+  shard.bytes += bytes;
+  shard.insertions++;
+  EvictOverBudget(shard);
+}
+
+void RouteCache::Invalidate() {
+  generation_.fetch_add(1, std::memory_order_acq_rel);
+  for (auto& shard : shards_) {
+    std::lock_guard<std::mutex> lock(shard->mutex);
+    shard->lru.clear();
+    shard->index.clear();
+    shard->bytes = 0;
+  }
+}
+
+RouteCacheStats RouteCache::GetStats() {
+  RouteCacheStats stats;
+  stats.capacity_bytes = shard_capacity_bytes_ * shards_.size();
+  for (auto& shard : shards_) {
+    std::lock_guard<std::mutex> lock(shard->mutex);
+    stats.hits += shard->hits;
+    stats.misses += shard->misses;
+    stats.insertions += shard->insertions;
+    stats.evictions += shard->evictions;
+    stats.entries += shard->lru.size();
+    stats.bytes += shard->bytes;
+  }
+  return stats;
+}
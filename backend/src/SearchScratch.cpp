@@ -0,0 +1,12 @@
+#include "../include/SearchScratch.h"
+#include <array>
+
+SearchScratch& GetThreadScratch(QueueType queue_type, int slot) {
+  // One scratch per queue type and slot, so each thread keeps warm buffers for every engine configuration it runs
+  thread_local std::array<SearchScratch, 3 * kScratchSlots> scratches;
+  SearchScratch& scratch = scratches[static_cast<int>(queue_type) * kScratchSlots + slot];
+  if (!scratch.queue) {
+    scratch.queue = MakeMinQueue(queue_type);
+  }
+  return scratch;
+}
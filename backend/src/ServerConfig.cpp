@@ -0,0 +1,252 @@
+#include "../include/ServerConfig.h"
+
+#include <charconv>
+#include <fstream>
+#include <functional>
+#include <string_view>
+#include <thread>
+
+namespace {
+
+// Parses a whole string as a non-negative integer no larger than max_value
+template <typename T>
+bool ParseNumber(std::string_view text, T max_value, T& out) {
+  unsigned long long value = 0;
+  const char* end = text.data() + text.size();
+  auto result = std::from_chars(text.data(), end, value);
+  if (text.empty() || result.ec != std::errc() || result.ptr != end ||
+      value > static_cast<unsigned long long>(max_value)) {
+    return false;
+  }
+  out = static_cast<T>(value);
+  return true;
+}
+
+bool ParseBool(std::string_view text, bool& out) {
+  if (text == "1" || text == "true" || text == "on") {
+    out = true;
+  } else if (text == "0" || text == "false" || text == "off") {
+    out = false;
+  } else {
+    return false;
+  }
+  return true;
+}
+
+std::string_view Trim(std::string_view text) {
+  const char* whitespace = " \t\r\n";
+  std::size_t first = text.find_first_not_of(whitespace);
+  if (first == std::string_view::npos) {
+    return {};
+  }
+  std::size_t last = text.find_last_not_of(whitespace);
+  return text.substr(first, last - first + 1);
+}
+
+struct Setting {
+  const char* name;
+  std::function<bool(std::string_view, ServerConfig&)> apply;
+};
+
+// Every setting accepted by the flags and the config file
+const Setting kSettings[] = {
+    {"host", [](std::string_view v, ServerConfig& c) { c.host = std::string(v); return !v.empty(); }},
+    {"port", [](std::string_view v, ServerConfig& c) { return ParseNumber(v, 65535, c.port); }},
+    {"threads", [](std::string_view v, ServerConfig& c) { return ParseNumber(v, 4096u, c.worker_threads); }},
+    {"max-queued", [](std::string_view v, ServerConfig& c) {
+       return ParseNumber(v, static_cast<std::size_t>(-1), c.max_queued_requests); }},
+    {"keep-alive-max", [](std::string_view v, ServerConfig& c) {
+       return ParseNumber(v, static_cast<std::size_t>(-1), c.keep_alive_max_count); }},
+    {"keep-alive-timeout", [](std::string_view v, ServerConfig& c) { return ParseNumber(v, 3600L, c.keep_alive_timeout); }},
+    {"read-timeout", [](std::string_view v, ServerConfig& c) { return ParseNumber(v, 3600L, c.read_timeout); }},
+    {"write-timeout", [](std::string_view v, ServerConfig& c) { return ParseNumber(v, 3600L, c.write_timeout); }},
+    {"max-payload", [](std::string_view v, ServerConfig& c) {
+       return ParseNumber(v, static_cast<std::size_t>(-1), c.payload_max_length); }},
+    {"route-cache-mb", [](std::string_view v, ServerConfig& c) { return ParseNumber(v, std::size_t(1) << 20, c.route_cache_mb); }},
+    {"route-cache-shards", [](std::string_view v, ServerConfig& c) {
+       return ParseNumber(v, std::size_t(1024), c.route_cache_shards) && c.route_cache_shards > 0; }},
+    {"route-tables", [](std::string_view v, ServerConfig& c) { return ParseBool(v, c.route_tables); }},
+    {"route-table-threads", [](std::string_view v, ServerConfig& c) { return ParseNumber(v, 4096u, c.route_table_threads); }},
+    {"landmarks", [](std::string_view v, ServerConfig& c) { return ParseNumber(v, 64, c.landmarks); }},
+    {"contraction-hierarchies", [](std::string_view v, ServerConfig& c) {
+       return ParseBool(v, c.contraction_hierarchies); }},
+    {"batch-max-queries", [](std::string_view v, ServerConfig& c) {
+       return ParseNumber(v, static_cast<std::size_t>(-1), c.batch_max_queries) && c.batch_max_queries > 0; }},
+    {"matrix-max-cells", [](std::string_view v, ServerConfig& c) {
+       return ParseNumber(v, static_cast<std::size_t>(-1), c.matrix_max_cells) && c.matrix_max_cells > 0; }},
+    {"batch-threads", [](std::string_view v, ServerConfig& c) { return ParseNumber(v, 4096u, c.batch_threads); }},
+    {"log-level", [](std::string_view v, ServerConfig& c) { return ParseLogLevel(v, c.log_level); }},
+    {"csv", [](std::string_view v, ServerConfig& c) { c.csv_path = std::string(v); return !v.empty(); }},
+    {"snapshot", [](std::string_view v, ServerConfig& c) { c.snapshot_path = std::string(v); return true; }},
+};
+
+bool ApplySetting(std::string_view name, std::string_view value, ServerConfig& config, std::string& error) {
+  for (const Setting& setting : kSettings) {
+    if (name == setting.name) {
+      if (!setting.apply(value, config)) {
+        error = "Invalid value for " + std::string(name) + ": '" + std::string(value) + "'";
+        return false;
+      }
+      return true;
+    }
+  }
+  error = "Unknown setting: " + std::string(name);
+  return false;
+}
+
+}  // namespace
+
+unsigned ServerConfig::EffectiveWorkerThreads() const {
+  if (worker_threads != 0) {
+    return worker_threads;
+  }
+  unsigned hardware_threads = std::thread::hardware_concurrency();
+  return hardware_threads != 0 ? hardware_threads : 1;
+}
+
+bool ParseServerConfig(int argc, const char* const argv[], ServerConfig& config, std::string& error,
+                       bool* help_requested) {
+  if (help_requested != nullptr) {
+    *help_requested = false;
+  }
+  for (int i = 1; i < argc; i++) {
+    std::string_view arg = argv[i];
+    if (arg == "--help" || arg == "-h") {
+      if (help_requested != nullptr) {
+        *help_requested = true;
+      }
+      continue;
+    }
+    if (arg.substr(0, 2) != "--") {
+      error = "Unexpected argument: " + std::string(arg);
+      return false;
+    }
+    arg.remove_prefix(2);
+
+    // Accept both --name=value and --name value
+    std::string_view name = arg;
+    std::string_view value;
+    std::size_t equals = arg.find('=');
+    if (equals != std::string_view::npos) {
+      name = arg.substr(0, equals);
+      value = arg.substr(equals + 1);
+    } else if (i + 1 < argc) {
+      value = argv[++i];
+    } else {
+      error = "Missing value for --" + std::string(name);
+      return false;
+    }
+
+    if (name == "config") {
+      if (!LoadServerConfigFile(std::string(value), config, error)) {
+        return false;
+      }
+    } else if (!ApplySetting(name, value, config, error)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool LoadServerConfigFile(const std::string& file_path, ServerConfig& config, std::string& error) {
+  std::ifstream file(file_path);
+  if (!file.is_open()) {
+    error = "Error opening file: " + file_path;
+    return false;
+  }
+
+  std::string line;
+  int line_number = 0;
+  while (std::getline(file, line)) {
+    line_number++;
+    std::string_view text = line;
+    std::size_t comment = text.find('#');
+    if (comment != std::string_view::npos) {
+      text = text.substr(0, comment);
+    }
+    text = Trim(text);
+    if (text.empty()) {
+      continue;
+    }
+
+    std::size_t equals = text.find('=');
+    if (equals == std::string_view::npos) {
+      error = file_path + ":" + std::to_string(line_number) + ": expected name = value";
+      return false;
+    }
+    if (!ApplySetting(Trim(text.substr(0, equals)), Trim(text.substr(equals + 1)), config, error)) {
+      error = file_path + ":" + std::to_string(line_number) + ": " + error;
+      return false;
+    }
+  }
+  return true;
+}
+
+void PrintServerConfig(std::ostream& out, const ServerConfig& config) {
+  out << "Server settings:" << std::endl;
+  out << "  bind address:        " << config.host << ":" << config.port << std::endl;
+  out << "  worker threads:      " << config.EffectiveWorkerThreads()
+      << (config.worker_threads == 0 ? " (hardware threads)" : "") << std::endl;
+  out << "  max queued requests: ";
+  if (config.max_queued_requests == 0) {
+    out << "unbounded" << std::endl;
+  } else {
+    out << config.max_queued_requests << std::endl;
+  }
+  out << "  keep-alive:          " << config.keep_alive_max_count << " requests, "
+      << config.keep_alive_timeout << " s idle timeout" << std::endl;
+  out << "  read/write timeout:  " << config.read_timeout << " s / " << config.write_timeout << " s" << std::endl;
+  out << "  max payload:         " << config.payload_max_length << " bytes" << std::endl;
+  out << "  route cache:         ";
+  if (config.route_cache_mb == 0) {
+    out << "disabled" << std::endl;
+  } else {
+    out << config.route_cache_mb << " MiB in " << config.route_cache_shards << " shards" << std::endl;
+  }
+  out << "  route tables:        ";
+  if (config.route_tables) {
+    out << "built in the background on "
+        << (config.route_table_threads == 0 ? "all hardware" : std::to_string(config.route_table_threads)) << " threads"
+        << std::endl;
+  } else {
+    out << "disabled" << std::endl;
+  }
+  out << "  A* landmarks:        " << config.landmarks << " per slice" << std::endl;
+  out << "  contraction hier.:   " << (config.contraction_hierarchies ? "built in the background" : "disabled")
+      << std::endl;
+  out << "  batches, matrices:   up to " << config.batch_max_queries << " queries / " << config.matrix_max_cells
+      << " cells on "
+      << (config.batch_threads == 0   ? "all hardware threads"
+          : config.batch_threads == 1 ? "the request's worker thread"
+                                      : std::to_string(config.batch_threads) + " threads")
+      << std::endl;
+  out << "  log level:           " << LogLevelName(config.log_level) << std::endl;
+  out << "  csv:                 " << config.csv_path << std::endl;
+  out << "  snapshot:            " << (config.snapshot_path.empty() ? "(disabled)" : config.snapshot_path) << std::endl;
+}
+
+const char* ServerConfigUsage() {
+  return "Usage: subway_server [--config FILE] [--name VALUE | --name=VALUE]...\n"
+         "  --host ADDRESS            bind address (default localhost; 0.0.0.0 for all interfaces)\n"
+         "  --port N                  listen port (default 8080)\n"
+         "  --threads N               worker threads, 0 = one per hardware thread (default 0)\n"
+         "  --max-queued N            requests waiting for a worker before new ones are refused, 0 = unbounded\n"
+         "  --keep-alive-max N        requests served per keep-alive connection (default 100)\n"
+         "  --keep-alive-timeout S    idle seconds before a keep-alive connection is closed (default 5)\n"
+         "  --read-timeout S          socket read timeout in seconds (default 5)\n"
+         "  --write-timeout S         socket write timeout in seconds (default 5)\n"
+         "  --max-payload BYTES       largest accepted request body (default 1048576)\n"
+         "  --route-cache-mb N        memory budget of the route result cache, 0 = disabled (default 64)\n"
+         "  --route-cache-shards N    independently locked cache shards (default 16)\n"
+         "  --route-tables 0|1        precompute all-pairs route tables in the background (default 0)\n"
+         "  --route-table-threads N   threads for the route table and hierarchy builds, 0 = one per hardware thread\n"
+         "  --landmarks N             ALT landmarks per slice for A*, 0 = coordinate heuristic (default 8)\n"
+         "  --contraction-hierarchies 0|1  build contraction hierarchies in the background (default 1)\n"
+         "  --batch-max-queries N     most queries in one /api/find-routes/batch request (default 10000)\n"
+         "  --matrix-max-cells N      most sources times targets in one /api/matrix request (default 1000000)\n"
+         "  --batch-threads N         threads answering one batch or matrix request, 0 = one per hardware thread\n"
+         "  --log-level LEVEL         debug, info, warning, error or off (default info)\n"
+         "  --csv PATH                travel time CSV\n"
+         "  --snapshot PATH           binary graph snapshot, empty to disable\n"
+         "  --config FILE             read 'name = value' lines using the names above\n";
+}
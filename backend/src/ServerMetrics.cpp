@@ -0,0 +1,174 @@
+#include "../include/ServerMetrics.h"
+#include <sstream>
+
+namespace {
+
+// Bucket upper bounds of the exported histograms: durations in seconds, settled stations as counts
+constexpr double kDurationBounds[] = {0.000001, 0.0000025, 0.000005, 0.00001, 0.000025, 0.00005, 0.0001,
+                                      0.00025,  0.0005,    0.001,    0.0025,  0.005,    0.01,    0.025,
+                                      0.05,     0.1,       0.25,     0.5,     1.0,      2.5,     5.0,    10.0};
+constexpr double kSettledBounds[] = {1, 2, 5, 10, 20, 50, 100, 200, 500, 1000, 2000, 5000};
+
+constexpr double kNanosecondsPerSecond = 1e9;
+
+}  // namespace
+
+ServerMetrics::ServerMetrics() {
+  for (auto& statuses : requests_) {
+    for (auto& count : statuses) {
+      count.store(0, std::memory_order_relaxed);
+    }
+  }
+}
+
+ServerMetrics::Endpoint ServerMetrics::EndpointForPath(const std::string& path) {
+  if (path == "/health") return Endpoint::Health;
+  if (path == "/api/find-route") return Endpoint::FindRoute;
+  if (path == "/api/find-routes/batch") return Endpoint::FindRoutesBatch;
+  if (path == "/api/matrix") return Endpoint::Matrix;
+  if (path == "/api/isochrone") return Endpoint::Isochrone;
+  if (path == "/api/compare-algorithms") return Endpoint::CompareAlgorithms;
+  if (path == "/metrics") return Endpoint::Metrics;
+  return Endpoint::Other;
+}
+
+const char* ServerMetrics::EndpointName(Endpoint endpoint) {
+  switch (endpoint) {
+    case Endpoint::Health: return "/health";
+    case Endpoint::FindRoute: return "/api/find-route";
+    case Endpoint::FindRoutesBatch: return "/api/find-routes/batch";
+    case Endpoint::Matrix: return "/api/matrix";
+    case Endpoint::Isochrone: return "/api/isochrone";
+    case Endpoint::CompareAlgorithms: return "/api/compare-algorithms";
+    case Endpoint::Metrics: return "/metrics";
+    default: return "other";
+  }
+}
+
+const char* ServerMetrics::StageName(Stage stage) {
+  switch (stage) {
+    case Stage::JsonParse: return "json_parse";
+    case Stage::StationLookup: return "station_lookup";
+    case Stage::CacheLookup: return "cache_lookup";
+    default: return "serialization";
+  }
+}
+
+const char* ServerMetrics::AlgorithmName(Algorithm algorithm) {
+  switch (algorithm) {
+    case Algorithm::Dijkstra: return "dijkstra";
+    case Algorithm::AStar: return "astar";
+    case Algorithm::BidirectionalDijkstra: return "bidirectional_dijkstra";
+    case Algorithm::ContractionHierarchy: return "contraction_hierarchy";
+    case Algorithm::AlternativeRoutes: return "alternative_routes";
+    case Algorithm::TimeDependentDijkstra: return "time_dependent_dijkstra";
+    default: return "route_table";
+  }
+}
+
+void ServerMetrics::RecordRequest(Endpoint endpoint, int status, std::uint64_t duration_ns) {
+  const std::size_t index = static_cast<std::size_t>(endpoint);
+  // Out of range statuses are counted as 0 rather than dropped
+  requests_[index][status > 0 && status < kMaxStatus ? status : 0].fetch_add(1, std::memory_order_relaxed);
+  request_duration_ns_[index].Record(duration_ns);
+}
+
+void ServerMetrics::RecordStage(Stage stage, std::uint64_t duration_ns) {
+  stage_duration_ns_[static_cast<std::size_t>(stage)].Record(duration_ns);
+}
+
+void ServerMetrics::RecordSearch(Algorithm algorithm, std::uint64_t duration_ns) {
+  search_duration_ns_[static_cast<std::size_t>(algorithm)].Record(duration_ns);
+}
+
+void ServerMetrics::RecordSearch(Algorithm algorithm, std::uint64_t duration_ns, std::uint64_t settled_stations) {
+  search_duration_ns_[static_cast<std::size_t>(algorithm)].Record(duration_ns);
+  settled_stations_[static_cast<std::size_t>(algorithm)].Record(settled_stations);
+}
+
+void ServerMetrics::RenderHistogram(std::ostream& out, const std::string& name, const std::string& labels,
+                                    const LatencyHistogram& histogram, const double* bounds, std::size_t bound_count,
+                                    double scale) {
+  const std::string prefix = labels.empty() ? "" : labels + ",";
+  for (std::size_t i = 0; i < bound_count; ++i) {
+    // Rounded to the nearest recorded unit so a bound of 1 us counts values of exactly 1000 ns
+    const auto bound = static_cast<std::uint64_t>(bounds[i] * scale + 0.5);
+    out << name << "_bucket{" << prefix << "le=\"" << bounds[i] << "\"} " << histogram.CountAtOrBelow(bound) << "\n";
+  }
+  // Writers may be mid-update, so the total is read once and used for both +Inf and _count to keep them equal
+  const std::uint64_t count = histogram.CountAtOrBelow(LatencyHistogram::kMaxValue);
+  out << name << "_bucket{" << prefix << "le=\"+Inf\"} " << count << "\n";
+  out << name << "_sum" << (labels.empty() ? "" : "{" + labels + "}") << " " << histogram.GetSum() / scale << "\n";
+  out << name << "_count" << (labels.empty() ? "" : "{" + labels + "}") << " " << count << "\n";
+}
+
+std::string ServerMetrics::Render(const RouteCacheStats& route_cache) const {
+  std::ostringstream out;
+  const std::size_t duration_bound_count = sizeof(kDurationBounds) / sizeof(kDurationBounds[0]);
+  const std::size_t settled_bound_count = sizeof(kSettledBounds) / sizeof(kSettledBounds[0]);
+
+  out << "# HELP subway_http_requests_total Requests served, by endpoint and response status.\n"
+      << "# TYPE subway_http_requests_total counter\n";
+  for (std::size_t endpoint = 0; endpoint < kEndpointCount; ++endpoint) {
+    for (int status = 0; status < kMaxStatus; ++status) {
+      const std::uint64_t count = requests_[endpoint][status].load(std::memory_order_relaxed);
+      if (count > 0) {
+        out << "subway_http_requests_total{endpoint=\"" << EndpointName(static_cast<Endpoint>(endpoint))
+            << "\",status=\"" << status << "\"} " << count << "\n";
+      }
+    }
+  }
+
+  out << "# HELP subway_http_request_duration_seconds Time from routing a request to sending its response.\n"
+      << "# TYPE subway_http_request_duration_seconds histogram\n";
+  for (std::size_t endpoint = 0; endpoint < kEndpointCount; ++endpoint) {
+    RenderHistogram(out, "subway_http_request_duration_seconds",
+                    std::string("endpoint=\"") + EndpointName(static_cast<Endpoint>(endpoint)) + "\"",
+                    request_duration_ns_[endpoint], kDurationBounds, duration_bound_count, kNanosecondsPerSecond);
+  }
+
+  out << "# HELP subway_stage_duration_seconds Time spent in each request handling step outside the search.\n"
+      << "# TYPE subway_stage_duration_seconds histogram\n";
+  for (std::size_t stage = 0; stage < kStageCount; ++stage) {
+    RenderHistogram(out, "subway_stage_duration_seconds",
+                    std::string("stage=\"") + StageName(static_cast<Stage>(stage)) + "\"", stage_duration_ns_[stage],
+                    kDurationBounds, duration_bound_count, kNanosecondsPerSecond);
+  }
+
+  out << "# HELP subway_search_duration_seconds Time of one route search, by algorithm.\n"
+      << "# TYPE subway_search_duration_seconds histogram\n";
+  for (std::size_t algorithm = 0; algorithm < kAlgorithmCount; ++algorithm) {
+    RenderHistogram(out, "subway_search_duration_seconds",
+                    std::string("algorithm=\"") + AlgorithmName(static_cast<Algorithm>(algorithm)) + "\"",
+                    search_duration_ns_[algorithm], kDurationBounds, duration_bound_count, kNanosecondsPerSecond);
+  }
+
+  out << "# HELP subway_search_settled_stations Stations settled by one route search, by algorithm.\n"
+      << "# TYPE subway_search_settled_stations histogram\n";
+  for (std::size_t algorithm = 0; algorithm < kAlgorithmCount; ++algorithm) {
+    // The precomputed tables do not search, so they have no settled stations to report
+    if (static_cast<Algorithm>(algorithm) == Algorithm::RouteTable) {
+      continue;
+    }
+    RenderHistogram(out, "subway_search_settled_stations",
+                    std::string("algorithm=\"") + AlgorithmName(static_cast<Algorithm>(algorithm)) + "\"",
+                    settled_stations_[algorithm], kSettledBounds, settled_bound_count, 1.0);
+  }
+
+  out << "# HELP subway_route_cache_hits_total Route cache lookups answered from the cache.\n"
+      << "# TYPE subway_route_cache_hits_total counter\n"
+      << "subway_route_cache_hits_total " << route_cache.hits << "\n"
+      << "# HELP subway_route_cache_misses_total Route cache lookups that had to search.\n"
+      << "# TYPE subway_route_cache_misses_total counter\n"
+      << "subway_route_cache_misses_total " << route_cache.misses << "\n"
+      << "# HELP subway_route_cache_evictions_total Routes evicted to stay within the cache budget.\n"
+      << "# TYPE subway_route_cache_evictions_total counter\n"
+      << "subway_route_cache_evictions_total " << route_cache.evictions << "\n"
+      << "# HELP subway_route_cache_entries Routes currently cached.\n"
+      << "# TYPE subway_route_cache_entries gauge\n"
+      << "subway_route_cache_entries " << route_cache.entries << "\n"
+      << "# HELP subway_route_cache_bytes Approximate memory held by cached routes.\n"
+      << "# TYPE subway_route_cache_bytes gauge\n"
+      << "subway_route_cache_bytes " << route_cache.bytes << "\n";
+  return out.str();
+}
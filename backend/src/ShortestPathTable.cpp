@@ -0,0 +1,149 @@
+#include "../include/ShortestPathTable.h"
+#include "../include/Dijkstra.h"
+#include "../include/Logger.h"
+#include "../include/ParallelFor.h"
+#include "../include/SearchScratch.h"
+#include <chrono>
+#include <iomanip>
+#include <limits>
+#include <sstream>
+
+ShortestPathTable::ShortestPathTable(const AdjacencyList* adj_list)
+    : adj_list_(adj_list), station_count_(0), ready_(false) {}
+
+ShortestPathTable::~ShortestPathTable() {
+  if (builder_.joinable()) {
+    builder_.join();
+  }
+}
+
+void ShortestPathTable::FillRow(const CsrGraph& graph, int start_id, SliceTable& table) {
+  const int station_count = graph.StationCount();
+  float* times = &table.times[static_cast<std::size_t>(start_id) * station_count];
+  std::uint16_t* next_hops = &table.next_hops[static_cast<std::size_t>(start_id) * station_count];
+
+  SearchScratch& scratch = GetThreadScratch(QueueType::QuaternaryHeap);
+  // Stations in the order they are settled, so every predecessor's first hop is known before its successors
+  thread_local std::vector<int> settled_order;
+  settled_order.clear();
+  SearchStats stats;
+  Dijkstra::SearchFrom(graph, start_id, scratch, stats, settled_order);
+
+  std::fill(times, times + station_count, std::numeric_limits<float>::infinity());
+  std::fill(next_hops, next_hops + station_count, kNoHop);
+  for (int station_id : settled_order) {
+    times[station_id] = static_cast<float>(scratch.state.GetDistance(station_id));
+    const int predecessor = scratch.state.GetPredecessor(station_id);
+    if (predecessor < 0 || predecessor == start_id) {
+      next_hops[station_id] = static_cast<std::uint16_t>(station_id);
+    } else {
+      next_hops[station_id] = next_hops[predecessor];
+    }
+  }
+}
+
+bool ShortestPathTable::Build(unsigned int thread_count, const std::vector<TimeSlice>& slices) {
+  const auto start_time = std::chrono::steady_clock::now();
+  station_count_ = adj_list_->GetStationCount();
+  if (station_count_ >= kNoHop) {
+    LOG_ERROR("Too many stations for 16-bit next hops: " << station_count_);
+    return false;
+  }
+  if (thread_count == 0) {
+    thread_count = std::max(1u, std::thread::hardware_concurrency());
+  }
+
+  std::vector<TimeSlice> build_slices = slices.empty() ? adj_list_->GetTimeSlices() : slices;
+  slices_.assign(TimeSlice::kCount, SliceTable());
+  report_ = ShortestPathTableReport();
+  const std::size_t pair_count = static_cast<std::size_t>(station_count_) * station_count_;
+  std::vector<std::pair<const CsrGraph*, SliceTable*>> jobs;
+  for (TimeSlice slice : build_slices) {
+    const CsrGraph* graph = adj_list_->GetCsrGraph(slice);
+    if (graph == nullptr || graph->StationCount() != station_count_) {
+      continue;
+    }
+    SliceTable& table = slices_[slice.Index()];
+    table.times.resize(pair_count);
+    table.next_hops.resize(pair_count);
+    jobs.emplace_back(graph, &table);
+
+    report_.slices++;
+    report_.table_bytes += pair_count * (sizeof(float) + sizeof(std::uint16_t));
+    report_.graph_bytes += graph->offsets.size() * sizeof(int) + graph->targets.size() * sizeof(int) +
+                           graph->weights.size() * sizeof(double);
+  }
+
+  // One work item per (slice, start station) so threads stay busy to the end
+  ParallelFor(jobs.size() * station_count_, thread_count, [&](std::size_t item) {
+    const auto& job = jobs[item / station_count_];
+    FillRow(*job.first, static_cast<int>(item % station_count_), *job.second);
+  });
+
+  report_.stations = station_count_;
+  report_.searches = static_cast<std::uint64_t>(jobs.size()) * station_count_;
+  report_.threads = thread_count;
+  report_.build_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start_time).count();
+  ready_.store(true, std::memory_order_release);
+  return true;
+}
+
+void ShortestPathTable::StartBackgroundBuild(unsigned int thread_count) {
+  builder_ = std::thread([this, thread_count]() {
+    if (Build(thread_count)) {
+      // Formatted first so the report reaches the log as one entry
+      std::ostringstream report;
+      PrintReport(report, report_);
+      LOG_INFO(report.str());
+    }
+  });
+}
+
+bool ShortestPathTable::HasSlice(TimeSlice slice) const {
+  return IsReady() && slice.IsValid() && !slices_[slice.Index()].times.empty();
+}
+
+float ShortestPathTable::GetTime(TimeSlice slice, int start_id, int end_id) const {
+  if (!HasSlice(slice) || start_id < 0 || end_id < 0 || start_id >= station_count_ || end_id >= station_count_) {
+    return std::numeric_limits<float>::infinity();
+  }
+  return slices_[slice.Index()].times[static_cast<std::size_t>(start_id) * station_count_ + end_id];
+}
+
+std::pair<double, std::vector<Station>> ShortestPathTable::GetQuickestPath(TimeSlice slice, int start_id,
+                                                                           int end_id) const {
+  if (!HasSlice(slice) || start_id < 0 || end_id < 0 || start_id >= station_count_ || end_id >= station_count_) {
+    return {-1, std::vector<Station>()};
+  }
+  const SliceTable& table = slices_[slice.Index()];
+  const std::uint16_t* next_hops = table.next_hops.data();
+
+  // Unreachable destinations match Dijkstra: infinite time and no path
+  if (next_hops[static_cast<std::size_t>(start_id) * station_count_ + end_id] == kNoHop) {
+    return {std::numeric_limits<double>::infinity(), std::vector<Station>()};
+  }
+
+  // Walk the next hops, summing the edge weights in path order so the time matches a Dijkstra search exactly
+  const CsrGraph& graph = *adj_list_->GetCsrGraph(slice);
+  std::vector<int> station_path{start_id};
+  double total_time = 0.0;
+  int curr_id = start_id;
+  while (curr_id != end_id && static_cast<int>(station_path.size()) <= station_count_) {
+    const int next_id = next_hops[static_cast<std::size_t>(curr_id) * station_count_ + end_id];
+    total_time += graph.EdgeWeight(curr_id, next_id);
+    station_path.push_back(next_id);
+    curr_id = next_id;
+  }
+
+  return std::make_pair(total_time, adj_list_->GetStationPath(station_path));
+}
+
+void ShortestPathTable::PrintReport(std::ostream& out, const ShortestPathTableReport& report) {
+  const double mib = 1024.0 * 1024.0;
+  out << "Shortest path tables: " << report.slices << " slices x " << report.stations << " stations, "
+      << report.searches << " searches on " << report.threads << " threads in " << std::fixed
+      << std::setprecision(2) << report.build_seconds << " s" << std::endl;
+  out << "  table memory " << report.table_bytes / mib << " MiB ("
+      << (report.slices > 0 ? report.table_bytes / report.slices / 1024.0 : 0.0) << " KiB per slice) vs CSR graphs "
+      << report.graph_bytes / mib << " MiB" << std::defaultfloat << std::endl;
+}
@@ -0,0 +1,330 @@
+#include "../include/TimeDependentDijkstra.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace {
+
+constexpr double kInfinity = std::numeric_limits<double>::infinity();
+
+}  // namespace
+
+// Buckets run 00-05, 05-09, 09-16, 16-20 and 20-24; the outer columns are the neighbouring days' night buckets
+const std::array<double, TimeDependentDijkstra::kColumnCount> TimeDependentDijkstra::kColumnStarts = {
+    -240, 0, 300, 540, 960, 1200, 1440};
+const std::array<double, TimeDependentDijkstra::kColumnCount> TimeDependentDijkstra::kColumnMidpoints = {
+    -120, 150, 420, 750, 1080, 1320, 1590};
+
+TimeOfDay TimeDependentDijkstra::TimeOfDayAt(double minute_of_day) {
+  const double hour = minute_of_day / 60;
+  if (hour >= 5 && hour < 9) return TimeOfDay::MorningRush;
+  if (hour >= 9 && hour < 16) return TimeOfDay::Midday;
+  if (hour >= 16 && hour < 20) return TimeOfDay::EveningRush;
+  if (hour >= 20 && hour < 24) return TimeOfDay::Evening;
+  return TimeOfDay::EarlyMorning;
+}
+
+int TimeDependentDijkstra::DayGraph::FindEdge(int from_id, int to_id) const {
+  // Each station's targets are sorted
+  auto begin = targets.begin() + offsets[from_id];
+  auto end = targets.begin() + offsets[from_id + 1];
+  auto it = std::lower_bound(begin, end, to_id);
+  return it != end && *it == to_id ? static_cast<int>(it - targets.begin()) : -1;
+}
+
+double TimeDependentDijkstra::EdgeTimeAt(const double* columns, double minute_of_day) {
+  const int column = static_cast<int>(TimeOfDayAt(minute_of_day)) + 1;
+  const double weight = columns[column];
+  if (std::isinf(weight)) {
+    // Wait for the next bucket the edge runs in; at its start the weight is that bucket's own
+    for (int later = column + 1; later < kColumnCount; ++later) {
+      if (!std::isinf(columns[later])) {
+        return kColumnStarts[later] - minute_of_day + columns[later];
+      }
+    }
+    return kInfinity;
+  }
+  const int neighbor = minute_of_day >= kColumnMidpoints[column] ? column + 1 : column - 1;
+  const double neighbor_weight = columns[neighbor];
+  if (std::isinf(neighbor_weight)) {
+    return weight;
+  }
+  const double fraction =
+      (minute_of_day - kColumnMidpoints[column]) / (kColumnMidpoints[neighbor] - kColumnMidpoints[column]);
+  return weight + (neighbor_weight - weight) * fraction;
+}
+
+TimeDependentDijkstra::DayGraph TimeDependentDijkstra::MergeDay(Month month, DayOfWeek day) const {
+  DayGraph day_graph;
+  std::array<const CsrGraph*, TimeSlice::kTimeOfDayCount> graphs{};
+  bool has_data = false;
+  for (int time_of_day = 0; time_of_day < TimeSlice::kTimeOfDayCount; ++time_of_day) {
+    graphs[time_of_day] = adj_list_->GetCsrGraph(TimeSlice(month, static_cast<TimeOfDay>(time_of_day), day));
+    has_data = has_data || graphs[time_of_day] != nullptr;
+  }
+  if (!has_data) {
+    return day_graph;
+  }
+
+  const int station_count = adj_list_->GetStationCount();
+  day_graph.offsets.assign(station_count + 1, 0);
+  std::vector<int> neighbors;
+  for (int from_id = 0; from_id < station_count; ++from_id) {
+    // Every station any of the day's slices can go to next, except the station itself
+    neighbors.clear();
+    for (const CsrGraph* graph : graphs) {
+      if (graph == nullptr || from_id >= graph->StationCount()) {
+        continue;
+      }
+      for (int edge = graph->offsets[from_id]; edge < graph->offsets[from_id + 1]; ++edge) {
+        if (graph->targets[edge] != from_id) {
+          neighbors.push_back(graph->targets[edge]);
+        }
+      }
+    }
+    std::sort(neighbors.begin(), neighbors.end());
+    neighbors.erase(std::unique(neighbors.begin(), neighbors.end()), neighbors.end());
+    day_graph.targets.insert(day_graph.targets.end(), neighbors.begin(), neighbors.end());
+    day_graph.weights.resize(day_graph.targets.size() * kColumnCount, kInfinity);
+    day_graph.offsets[from_id + 1] = static_cast<int>(day_graph.targets.size());
+
+    for (int time_of_day = 0; time_of_day < TimeSlice::kTimeOfDayCount; ++time_of_day) {
+      const CsrGraph* graph = graphs[time_of_day];
+      if (graph == nullptr || from_id >= graph->StationCount()) {
+        continue;
+      }
+      for (int edge = graph->offsets[from_id]; edge < graph->offsets[from_id + 1]; ++edge) {
+        const int merged = day_graph.FindEdge(from_id, graph->targets[edge]);
+        if (merged >= 0) {
+          double& weight = day_graph.weights[merged * kColumnCount + time_of_day + 1];
+          weight = std::min(weight, graph->weights[edge]);
+        }
+      }
+    }
+  }
+  return day_graph;
+}
+
+void TimeDependentDijkstra::ClampWeek(Month month, int from_id, int to_id) {
+  // Slot day * kTimeOfDayCount + time_of_day holds that bucket's weight of the edge, null where the day lacks it
+  constexpr int kSlotCount = TimeSlice::kDayOfWeekCount * TimeSlice::kTimeOfDayCount;
+  std::array<double*, kSlotCount> slots{};
+  for (int day = 0; day < TimeSlice::kDayOfWeekCount; ++day) {
+    DayGraph& day_graph = days_[DayIndex(month, static_cast<DayOfWeek>(day))];
+    const int edge = day_graph.IsBuilt() ? day_graph.FindEdge(from_id, to_id) : -1;
+    for (int time_of_day = 0; edge >= 0 && time_of_day < TimeSlice::kTimeOfDayCount; ++time_of_day) {
+      slots[day * TimeSlice::kTimeOfDayCount + time_of_day] = &day_graph.weights[edge * kColumnCount + time_of_day + 1];
+    }
+  }
+  auto has_weight = [&slots](int slot) {
+    return slots[slot % kSlotCount] != nullptr && !std::isinf(*slots[slot % kSlotCount]);
+  };
+  // Minutes after the first Monday's midnight; slots past the end of the week are the next week's
+  auto start = [](int slot) {
+    return slot / TimeSlice::kTimeOfDayCount * kMinutesPerDay + kColumnStarts[slot % TimeSlice::kTimeOfDayCount + 1];
+  };
+  auto midpoint = [](int slot) {
+    return slot / TimeSlice::kTimeOfDayCount * kMinutesPerDay +
+           kColumnMidpoints[slot % TimeSlice::kTimeOfDayCount + 1];
+  };
+
+  // A bucket may be quicker than the one before it by at most the minutes between their midpoints, or after
+  // buckets without the edge, by the minutes waited. Raising one weight can require raising the next, around
+  // the week; a raise loses a week's minutes per lap, so this settles within a few laps
+  bool changed = true;
+  while (changed) {
+    changed = false;
+    for (int slot = 0; slot < kSlotCount; ++slot) {
+      if (!has_weight(slot)) {
+        continue;
+      }
+      int later = slot + 1;
+      while (later < slot + kSlotCount && !has_weight(later)) {
+        ++later;
+      }
+      if (later == slot + kSlotCount) {
+        break;
+      }
+      const double gap = later == slot + 1 ? midpoint(later) - midpoint(slot) : start(later) - start(slot + 1);
+      double& weight = *slots[later % kSlotCount];
+      if (weight < *slots[slot] - gap) {
+        weight = *slots[slot] - gap;
+        changed = true;
+      }
+    }
+  }
+}
+
+void TimeDependentDijkstra::Build() {
+  days_.assign(TimeSlice::kMonthCount * TimeSlice::kDayOfWeekCount, DayGraph());
+  for (int month = 0; month < TimeSlice::kMonthCount; ++month) {
+    for (int day = 0; day < TimeSlice::kDayOfWeekCount; ++day) {
+      days_[DayIndex(static_cast<Month>(month), static_cast<DayOfWeek>(day))] =
+          MergeDay(static_cast<Month>(month), static_cast<DayOfWeek>(day));
+    }
+  }
+
+  // Clamp every day before copying the night columns, so both sides of midnight see the same weights.
+  // Each edge is clamped once, for the whole week, from the first day that has it
+  for (int month = 0; month < TimeSlice::kMonthCount; ++month) {
+    for (int day = 0; day < TimeSlice::kDayOfWeekCount; ++day) {
+      const DayGraph& day_graph = days_[DayIndex(static_cast<Month>(month), static_cast<DayOfWeek>(day))];
+      for (int from_id = 0; from_id + 1 < static_cast<int>(day_graph.offsets.size()); ++from_id) {
+        for (int edge = day_graph.offsets[from_id]; edge < day_graph.offsets[from_id + 1]; ++edge) {
+          const int to_id = day_graph.targets[edge];
+          bool clamped = false;
+          for (int earlier = 0; earlier < day && !clamped; ++earlier) {
+            const DayGraph& other = days_[DayIndex(static_cast<Month>(month), static_cast<DayOfWeek>(earlier))];
+            clamped = other.IsBuilt() && other.FindEdge(from_id, to_id) >= 0;
+          }
+          if (!clamped) {
+            ClampWeek(static_cast<Month>(month), from_id, to_id);
+          }
+        }
+      }
+    }
+  }
+
+  // Around midnight the neighbouring days' night buckets are interpolated towards
+  const int evening_column = static_cast<int>(TimeOfDay::Evening) + 1;
+  const int early_morning_column = static_cast<int>(TimeOfDay::EarlyMorning) + 1;
+  for (int month = 0; month < TimeSlice::kMonthCount; ++month) {
+    for (int day = 0; day < TimeSlice::kDayOfWeekCount; ++day) {
+      DayGraph& day_graph = days_[DayIndex(static_cast<Month>(month), static_cast<DayOfWeek>(day))];
+      if (!day_graph.IsBuilt()) {
+        continue;
+      }
+      const DayGraph& previous = days_[DayIndex(static_cast<Month>(month),
+                                                static_cast<DayOfWeek>((day + TimeSlice::kDayOfWeekCount - 1) %
+                                                                       TimeSlice::kDayOfWeekCount))];
+      const DayGraph& next =
+          days_[DayIndex(static_cast<Month>(month), static_cast<DayOfWeek>((day + 1) % TimeSlice::kDayOfWeekCount))];
+
+      for (int from_id = 0; from_id + 1 < static_cast<int>(day_graph.offsets.size()); ++from_id) {
+        for (int edge = day_graph.offsets[from_id]; edge < day_graph.offsets[from_id + 1]; ++edge) {
+          double* columns = &day_graph.weights[edge * kColumnCount];
+          const int to_id = day_graph.targets[edge];
+          const int previous_edge = previous.IsBuilt() ? previous.FindEdge(from_id, to_id) : -1;
+          if (previous_edge >= 0) {
+            columns[0] = previous.weights[previous_edge * kColumnCount + evening_column];
+          }
+          const int next_edge = next.IsBuilt() ? next.FindEdge(from_id, to_id) : -1;
+          if (next_edge >= 0) {
+            columns[kColumnCount - 1] = next.weights[next_edge * kColumnCount + early_morning_column];
+          }
+        }
+      }
+    }
+  }
+}
+
+const TimeDependentDijkstra::DayGraph* TimeDependentDijkstra::DayAt(Month month, DayOfWeek departure_day,
+                                                                    double minute, DayOfWeek& day,
+                                                                    double& minute_of_day) const {
+  const double day_offset = std::floor(minute / kMinutesPerDay);
+  minute_of_day = minute - day_offset * kMinutesPerDay;
+  day = static_cast<DayOfWeek>((static_cast<int>(departure_day) + static_cast<int>(day_offset)) %
+                               TimeSlice::kDayOfWeekCount);
+  const DayGraph& day_graph = days_[DayIndex(month, day)];
+  return day_graph.IsBuilt() ? &day_graph : nullptr;
+}
+
+double TimeDependentDijkstra::EdgeTimeFrom(Month month, DayOfWeek day, const DayGraph& day_graph, int from_id,
+                                           int edge, double minute_of_day) const {
+  const double time = EdgeTimeAt(&day_graph.weights[edge * kColumnCount], minute_of_day);
+  if (!std::isinf(time)) {
+    return time;
+  }
+  // Nothing left today or early tomorrow: wait for the first later day that has the edge at all
+  const int to_id = day_graph.targets[edge];
+  double waited = kMinutesPerDay - minute_of_day;
+  for (int offset = 1; offset <= TimeSlice::kDayOfWeekCount; ++offset) {
+    const DayGraph& later =
+        days_[DayIndex(month, static_cast<DayOfWeek>((static_cast<int>(day) + offset) % TimeSlice::kDayOfWeekCount))];
+    const int later_edge = later.IsBuilt() ? later.FindEdge(from_id, to_id) : -1;
+    if (later_edge >= 0) {
+      const double later_time = EdgeTimeAt(&later.weights[later_edge * kColumnCount], 0);
+      if (!std::isinf(later_time)) {
+        return waited + later_time;
+      }
+    }
+    waited += kMinutesPerDay;
+  }
+  return kInfinity;
+}
+
+double TimeDependentDijkstra::EdgeTime(Month month, DayOfWeek day, int from_id, int to_id,
+                                       double minute_of_day) const {
+  if (days_.empty()) {
+    return kInfinity;
+  }
+  const DayGraph& day_graph = days_[DayIndex(month, day)];
+  const int station_count = static_cast<int>(day_graph.offsets.size()) - 1;
+  if (!day_graph.IsBuilt() || from_id < 0 || to_id < 0 || from_id >= station_count || to_id >= station_count) {
+    return kInfinity;
+  }
+  const int edge = day_graph.FindEdge(from_id, to_id);
+  return edge < 0 ? kInfinity : EdgeTimeFrom(month, day, day_graph, from_id, edge, minute_of_day);
+}
+
+std::pair<double, std::vector<Station>> TimeDependentDijkstra::GetQuickestPath(Month month, DayOfWeek day,
+                                                                               double departure_minute, int start_id,
+                                                                               int end_id, SearchStats* stats) const {
+  const int station_count = adj_list_->GetStationCount();
+  if (days_.empty() || !days_[DayIndex(month, day)].IsBuilt() || !(departure_minute >= 0) || start_id < 0 ||
+      end_id < 0 || start_id >= station_count || end_id >= station_count) {
+    return {-1, std::vector<Station>()};
+  }
+
+  // Labels are arrival times in minutes after the departure day's midnight
+  SearchScratch& scratch = GetThreadScratch(queue_type_);
+  scratch.Reset(station_count);
+  const QueueStats queue_before = scratch.queue->GetStats();
+  SearchStats work;
+
+  scratch.state.SetDistance(start_id, departure_minute, -1);
+  scratch.queue->Push(start_id, departure_minute);
+  while (!scratch.queue->Empty()) {
+    QueueEntry curr = scratch.queue->Pop();
+    if (curr.key > scratch.state.GetDistance(curr.station_id)) {
+      continue;
+    }
+    ++work.settled;
+    if (curr.station_id == end_id) {
+      break;
+    }
+
+    // Edges are priced by the slice active when the traveller reaches this station
+    DayOfWeek curr_day;
+    double minute_of_day;
+    const DayGraph* day_graph = DayAt(month, day, curr.key, curr_day, minute_of_day);
+    if (day_graph == nullptr) {
+      continue;
+    }
+    for (int edge = day_graph->offsets[curr.station_id]; edge < day_graph->offsets[curr.station_id + 1]; ++edge) {
+      const int to_id = day_graph->targets[edge];
+      const double arrival =
+          curr.key + EdgeTimeFrom(month, curr_day, *day_graph, curr.station_id, edge, minute_of_day);
+      ++work.relaxed;
+      if (arrival < scratch.state.GetDistance(to_id)) {
+        scratch.state.SetDistance(to_id, arrival, curr.station_id);
+        scratch.queue->Push(to_id, arrival);
+      }
+    }
+  }
+
+  work.AddQueueOperations(queue_before, scratch.queue->GetStats());
+  if (stats != nullptr) {
+    stats->Add(work);
+  }
+
+  if (!scratch.state.IsReached(end_id)) {
+    return {kInfinity, std::vector<Station>()};
+  }
+  std::vector<int> station_path;
+  for (int station_id = end_id; station_id != -1; station_id = scratch.state.GetPredecessor(station_id)) {
+    station_path.push_back(station_id);
+  }
+  std::reverse(station_path.begin(), station_path.end());
+  return {scratch.state.GetDistance(end_id) - departure_minute, adj_list_->GetStationPath(station_path)};
+}
@@ -0,0 +1,56 @@
+#include "../include/TimeSlice.h"
+
+namespace {
+
+const std::array<const char*, TimeSlice::kMonthCount> kMonthNames = {
+    "January", "February", "March", "April", "May", "June",
+    "July", "August", "September", "October", "November", "December",
+};
+
+const std::array<const char*, TimeSlice::kTimeOfDayCount> kTimeOfDayNames = {
+    "early_morning", "morning_rush", "midday", "evening_rush", "evening",
+};
+
+const std::array<const char*, TimeSlice::kDayOfWeekCount> kDayOfWeekNames = {
+    "Monday", "Tuesday", "Wednesday", "Thursday", "Friday", "Saturday", "Sunday",
+};
+
+// Returns the position of name in names, or -1 if it is not there
+template <std::size_t N>
+int FindName(const std::array<const char*, N>& names, const std::string& name) {
+  for (std::size_t i = 0; i < N; ++i) {
+    if (name == names[i]) {
+      return static_cast<int>(i);
+    }
+  }
+  return -1;
+}
+
+}  // namespace
+
+TimeSlice TimeSlice::FromCompositeKey(const std::array<std::string, 3>& composite_key) {
+  const int month = FindName(kMonthNames, composite_key[0]);
+  const int time_of_day = FindName(kTimeOfDayNames, composite_key[1]);
+  const int day_of_week = FindName(kDayOfWeekNames, composite_key[2]);
+  if (month == -1 || time_of_day == -1 || day_of_week == -1) {
+    return TimeSlice();
+  }
+  return TimeSlice(static_cast<Month>(month), static_cast<TimeOfDay>(time_of_day),
+                   static_cast<DayOfWeek>(day_of_week));
+}
+
+TimeSlice TimeSlice::FromIndex(int index) {
+  if (index < 0 || index >= kCount) {
+    return TimeSlice();
+  }
+  return TimeSlice(static_cast<std::uint16_t>(index));
+}
+
+std::array<std::string, 3> TimeSlice::ToCompositeKey() const {
+  if (!IsValid()) {
+    return {};
+  }
+  return {kMonthNames[static_cast<int>(GetMonth())],
+          kTimeOfDayNames[static_cast<int>(GetTimeOfDay())],
+          kDayOfWeekNames[static_cast<int>(GetDayOfWeek())]};
+}
@@ -5,12 +5,31 @@
 #include <string>
 #include <chrono>
 #include <random>
+#include <sstream>
 #include <algorithm>
+#include <cctype>
+#include <cstdio>
+#include <cstring>
 #include <ctime>
+#include <limits>
+#include <unordered_map>
 #include "json.hpp"
 #include "../include/AdjacencyList.h"
+#include "../include/AlternativeRoutes.h"
 #include "../include/Dijkstra.h"
 #include "../include/AStar.h"
+#include "../include/BidirectionalDijkstra.h"
+#include "../include/ContractionHierarchy.h"
+#include "../include/DistanceMatrix.h"
+#include "../include/LandmarkTable.h"
+#include "../include/Logger.h"
+#include "../include/ParallelFor.h"
+#include "../include/RouteCache.h"
+#include "../include/SearchTrace.h"
+#include "../include/ServerMetrics.h"
+#include "../include/ServerConfig.h"
+#include "../include/ShortestPathTable.h"
+#include "../include/TimeDependentDijkstra.h"
 
 // Include the HTTP library (you'll need to install cpp-httplib)
 #include "httplib.h"
@@ -19,34 +38,75 @@ using json = nlohmann::json;
 using namespace std;
 
 // Global variables for the graph and algorithms
+// Read-only once loaded: handlers pass the time slice to every search, and search state is per thread
 AdjacencyList* global_adj_list = nullptr;
 Dijkstra* global_dijkstra = nullptr;
 AStar* global_astar = nullptr;
+BidirectionalDijkstra* global_bidirectional = nullptr;
+// Landmark lower bounds for A*
+LandmarkTable* global_landmarks = nullptr;
+// Finished /api/find-route results; anything that reloads global_adj_list must call Invalidate()
+RouteCache* global_route_cache = nullptr;
+// All-pairs tables built in the background; /api/find-route uses them once a slice is ready
+ShortestPathTable* global_route_table = nullptr;
+// Quicker than the plain engines and ready sooner than the tables
+ContractionHierarchy* global_hierarchy = nullptr;
+// Up to kMaxAlternatives routes per /api/find-route request that asks for k of them
+AlternativeRoutes* global_alternatives = nullptr;
+constexpr int kMaxAlternatives = 10;
+// Prices every edge at the time it is reached, for /api/find-route requests that ask for it
+TimeDependentDijkstra* global_time_dependent = nullptr;
+// Travel time matrices for /api/matrix, using global_hierarchy for buckets once it is built
+DistanceMatrix* global_matrix = nullptr;
+// Request counts and stage timings served by /metrics
+ServerMetrics* global_metrics = nullptr;
+// When the request this worker thread is handling was routed, for the request duration metric
+thread_local chrono::steady_clock::time_point request_start_time;
 
-// Helper function to generate exploration steps based on route
-vector<string> generateExplorationSteps(const vector<string>& route, bool isDijkstra) {
+// Helper function to name the stations of a traced search in the order they were settled
+vector<string> getExplorationSteps(const RecordingTrace& trace) {
     vector<string> exploration;
-    
-    // Add some realistic exploration steps based on the route
-    for (size_t i = 0; i < route.size(); i++) {
-        // Add the current station
-        exploration.push_back(route[i]);
-        
-        // Add some "exploration" of nearby stations (more for Dijkstra, less for A*)
-        if (i < route.size() - 1) {
-            int extraExplorations = isDijkstra ? 2 : 1; // Dijkstra explores more
-            
-            for (int j = 0; j < extraExplorations; j++) {
-                // Simulate exploring nearby stations
-                string nearbyStation = route[i] + " (explored)";
-                exploration.push_back(nearbyStation);
-            }
-        }
+    exploration.reserve(trace.settled.size());
+    for (int station_id : trace.settled) {
+        const Station* station = global_adj_list->GetStation(station_id);
+        exploration.push_back(station ? station->station_name : to_string(station_id));
     }
-    
     return exploration;
 }
 
+// Helper function to report the counters of a traced search
+json getTraceCounts(const RecordingTrace& trace) {
+    return {
+        {"relaxations", trace.relaxations},
+        {"improving_relaxations", trace.improving_relaxations},
+        {"queue_pushes", trace.pushes},
+        {"queue_pops", trace.pops},
+        {"stale_pops", trace.stale_pops}
+    };
+}
+
+// Helper function to pack a travel time matrix for the binary /api/matrix response:
+// "SMX1", the row and column counts as little-endian uint32, then the times row-major as little-endian float32
+string encodeMatrixBinary(uint32_t rows, uint32_t columns, const vector<double>& times) {
+    string out;
+    out.reserve(12 + times.size() * 4);
+    out.append("SMX1");
+    auto append_u32 = [&out](uint32_t value) {
+        for (int shift = 0; shift < 32; shift += 8) {
+            out.push_back(static_cast<char>((value >> shift) & 0xFF));
+        }
+    };
+    append_u32(rows);
+    append_u32(columns);
+    for (double time : times) {
+        float value = static_cast<float>(time);
+        uint32_t bits;
+        memcpy(&bits, &value, sizeof(bits));
+        append_u32(bits);
+    }
+    return out;
+}
+
 // Helper function to convert time string to time_of_day category
 string timeToCategory(const string& time) {
     int hour = stoi(time.substr(0, 2));
@@ -57,6 +117,23 @@ string timeToCategory(const string& time) {
     return "early_morning"; // 0-5 AM
 }
 
+// Helper function to convert an "HH:MM" time string to minutes after midnight
+int timeToMinutes(const string& time) {
+    int minutes = stoi(time.substr(0, 2)) * 60;
+    if (time.size() >= 5 && time[2] == ':') {
+        minutes += stoi(time.substr(3, 2));
+    }
+    return minutes;
+}
+
+// Helper function to format minutes after midnight as "HH:MM", wrapping past midnight
+string minutesToTime(double minutes) {
+    int total = static_cast<int>(minutes + 0.5) % static_cast<int>(TimeDependentDijkstra::kMinutesPerDay);
+    char buffer[16];
+    snprintf(buffer, sizeof(buffer), "%02d:%02d", total / 60, total % 60);
+    return buffer;
+}
+
 // Helper function to convert day number to day name
 string dayNumberToName(int day) {
     switch(day) {
@@ -71,11 +148,23 @@ string dayNumberToName(int day) {
     }
 }
 
+// Helper function to read the local time in request handlers
+// localtime returns a pointer to shared static storage, so concurrent handlers use the reentrant variant
+tm getLocalTime() {
+    time_t now = time(0);
+    tm local_time{};
+#ifdef _WIN32
+    localtime_s(&local_time, &now);
+#else
+    localtime_r(&now, &local_time);
+#endif
+    return local_time;
+}
+
 // Helper function to get current month from system time
 string getCurrentMonth() {
-    time_t now = time(0);
-    tm* ltm = localtime(&now);
-    switch(ltm->tm_mon) {
+    tm ltm = getLocalTime();
+    switch(ltm.tm_mon) {
         case 6: return "July";
         case 7: return "August";
         case 8: return "September";
@@ -87,37 +176,109 @@ string getCurrentMonth() {
 
 // Helper function to get current day from system time
 string getCurrentDay() {
-    time_t now = time(0);
-    tm* ltm = localtime(&now);
-    return dayNumberToName(ltm->tm_wday == 0 ? 7 : ltm->tm_wday);
+    tm ltm = getLocalTime();
+    return dayNumberToName(ltm.tm_wday == 0 ? 7 : ltm.tm_wday);
 }
 
-int main() {
+int main(int argc, char* argv[]) {
+    // Read server settings: defaults, then --config file, then command line flags
+    ServerConfig config;
+    string config_error;
+    bool help_requested = false;
+    if (!ParseServerConfig(argc, argv, config, config_error, &help_requested)) {
+        // Through the logger like every other line; it is written before the process exits
+        LOG_ERROR(config_error << "\n" << ServerConfigUsage());
+        return 1;
+    }
+    if (help_requested) {
+        cout << ServerConfigUsage();
+        return 0;
+    }
+    Logger::Instance().SetLevel(config.log_level);
+    ostringstream config_summary;
+    PrintServerConfig(config_summary, config);
+    LOG_INFO(config_summary.str());
+
     // Initialize the graph and load data
-    cout << "Loading subway data..." << endl;
+    LOG_INFO("Loading subway data...");
     global_adj_list = new AdjacencyList();
-    // Fixed: Correct path from backend/build/Debug/ to data/subway_travel_times.csv
-    global_adj_list->LoadFromCSV("../../../data/subway_travel_times.csv");
+    // Fixed: Correct path from backend/build/Debug/ to data/subway_travel_times.csv (the default --csv)
+    // Restart from the binary snapshot when there is one built from the current CSV, otherwise parse the CSV and
+    // write the snapshot for next time
+    const string& csv_path = config.csv_path;
+    const string& snapshot_path = config.snapshot_path;
+    if (!snapshot_path.empty() && global_adj_list->LoadFromSnapshot(snapshot_path, csv_path)) {
+        LOG_INFO("Loaded graph snapshot " << snapshot_path);
+    } else {
+        global_adj_list->LoadFromCSV(csv_path, CsvLoadMode::Parallel);
+        if (!snapshot_path.empty() && global_adj_list->SaveSnapshot(snapshot_path, csv_path)) {
+            LOG_INFO("Wrote graph snapshot " << snapshot_path);
+        }
+    }
     
     // Initialize both algorithms
     global_dijkstra = new Dijkstra(global_adj_list);
     global_astar = new AStar(global_adj_list);
+    // Landmarks take two one-to-all searches per landmark and slice, so they are ready before serving
+    auto landmark_start_time = chrono::steady_clock::now();
+    global_landmarks = new LandmarkTable(global_adj_list);
+    global_landmarks->Build(config.landmarks, config.route_table_threads);
+    global_astar->SetLandmarks(global_landmarks);
+    LOG_INFO("Built " << config.landmarks << " A* landmarks per slice ("
+             << global_landmarks->MemoryBytes() / 1024 << " KiB) in "
+             << chrono::duration<double, milli>(chrono::steady_clock::now() - landmark_start_time).count() << " ms");
+    global_bidirectional = new BidirectionalDijkstra(global_adj_list);
+    global_route_cache = new RouteCache(config.route_cache_mb << 20, config.route_cache_shards);
+    global_hierarchy = new ContractionHierarchy(global_adj_list);
+    if (config.contraction_hierarchies) {
+        global_hierarchy->StartBackgroundBuild(config.route_table_threads);
+    }
+    global_route_table = new ShortestPathTable(global_adj_list);
+    global_matrix = new DistanceMatrix(global_adj_list, global_hierarchy);
+    global_alternatives = new AlternativeRoutes(global_adj_list);
+    // Merging each day's slices is a pass over the edges, so it is done before serving
+    auto time_dependent_start_time = chrono::steady_clock::now();
+    global_time_dependent = new TimeDependentDijkstra(global_adj_list);
+    global_time_dependent->Build();
+    LOG_INFO("Built time-dependent day graphs in "
+             << chrono::duration<double, milli>(chrono::steady_clock::now() - time_dependent_start_time).count()
+             << " ms");
+    global_metrics = new ServerMetrics();
+    if (config.route_tables) {
+        global_route_table->StartBackgroundBuild(config.route_table_threads);
+    }
     
-    cout << "Data loaded successfully!" << endl;
+    LOG_INFO("Data loaded successfully!");
     
-    // Debug: Print some loaded stations
-    cout << "Debug: Checking loaded stations..." << endl;
-    // Use actual coordinates from CSV: 1 Av (40.730953,-73.981628), 3 Av (40.732849,-73.986122)
-    Station test_station1{"1 Av", {40.730953, -73.981628}};
-    Station test_station2{"3 Av", {40.732849, -73.986122}};
-    int id1 = global_adj_list->GetStationId(test_station1);
-    int id2 = global_adj_list->GetStationId(test_station2);
-    cout << "Debug: '1 Av' ID: " << id1 << ", '3 Av' ID: " << id2 << endl;
-    cout << "Starting HTTP server on port 8080..." << endl;
+    // Debug: Log some loaded stations
+    if (SUBWAY_LOG_ENABLED(LogLevel::Debug)) {
+        LOG_DEBUG("Checking loaded stations...");
+        // Use actual coordinates from CSV: 1 Av (40.730953,-73.981628), 3 Av (40.732849,-73.986122)
+        Station test_station1{"1 Av", {40.730953, -73.981628}};
+        Station test_station2{"3 Av", {40.732849, -73.986122}};
+        int id1 = global_adj_list->GetStationId(test_station1);
+        int id2 = global_adj_list->GetStationId(test_station2);
+        LOG_DEBUG("'1 Av' ID: " << id1 << ", '3 Av' ID: " << id2);
+    }
+    LOG_INFO("Starting HTTP server on " << config.host << ":" << config.port << "...");
 
     // Create HTTP server
     httplib::Server svr;
 
+    // Size the worker pool and connection limits from the config instead of httplib's compiled-in defaults
+    const size_t worker_threads = config.EffectiveWorkerThreads();
+    const size_t max_queued_requests = config.max_queued_requests;
+    svr.new_task_queue = [worker_threads, max_queued_requests] {
+        return new httplib::ThreadPool(worker_threads, max_queued_requests);
+    };
+    svr.set_keep_alive_max_count(config.keep_alive_max_count);
+    svr.set_keep_alive_timeout(config.keep_alive_timeout);
+    svr.set_read_timeout(config.read_timeout);
+    svr.set_write_timeout(config.write_timeout);
+    svr.set_payload_max_length(config.payload_max_length);
+    // Responses are written in pieces; without this Nagle holds the last one back for the client's delayed ACK
+    svr.set_tcp_nodelay(true);
+
     // Add CORS headers to all responses
     svr.set_default_headers({
         {"Access-Control-Allow-Origin", "*"},
@@ -125,6 +286,16 @@ int main() {
         {"Access-Control-Allow-Headers", "Content-Type"}
     });
 
+    // Time every request from routing until it is logged, and count it by endpoint and status
+    svr.set_pre_routing_handler([](const httplib::Request&, httplib::Response&) {
+        request_start_time = chrono::steady_clock::now();
+        return httplib::Server::HandlerResponse::Unhandled;
+    });
+    svr.set_logger([](const httplib::Request& req, const httplib::Response& res) {
+        global_metrics->RecordRequest(ServerMetrics::EndpointForPath(req.path), res.status,
+                                      ServerMetrics::NanosecondsSince(request_start_time));
+    });
+
     // Handle preflight OPTIONS requests
     svr.Options("/(.*)", [](const httplib::Request&, httplib::Response& res) {
         res.status = 200;
@@ -132,23 +303,61 @@ int main() {
 
     // Health check endpoint
     svr.Get("/health", [](const httplib::Request&, httplib::Response& res) {
+        RouteCacheStats cache_stats = global_route_cache->GetStats();
         json response = {
             {"status", "ok"},
-            {"timestamp", "2024-01-15T10:30:00Z"}
+            {"timestamp", "2024-01-15T10:30:00Z"},
+            {"route_cache", {
+                {"hits", cache_stats.hits},
+                {"misses", cache_stats.misses},
+                {"evictions", cache_stats.evictions},
+                {"entries", cache_stats.entries},
+                {"bytes", cache_stats.bytes},
+                {"capacity_bytes", cache_stats.capacity_bytes}
+            }}
         };
         res.set_content(response.dump(), "application/json");
     });
 
+    // Prometheus metrics endpoint
+    svr.Get("/metrics", [](const httplib::Request&, httplib::Response& res) {
+        res.set_content(global_metrics->Render(global_route_cache->GetStats()), "text/plain; version=0.0.4");
+    });
+
     // Route finding endpoint
     svr.Post("/api/find-route", [](const httplib::Request& req, httplib::Response& res) {
         try {
             // Parse JSON request
+            auto parse_start_time = chrono::steady_clock::now();
             json request = json::parse(req.body);
             
             // Extract parameters
             string start_station = request["start_station"];
             string end_station = request["end_station"];
             string time = request["time"];
+            // Number of routes wanted; above 1 the response also lists alternatives
+            int k = request.value("k", 1);
+            // Price each edge at the time it is reached instead of using the departure slice for the whole trip
+            bool time_dependent = request.value("time_dependent", false);
+            global_metrics->RecordStage(ServerMetrics::Stage::JsonParse, ServerMetrics::NanosecondsSince(parse_start_time));
+            if (k < 1 || k > kMaxAlternatives) {
+                json error_response = {
+                    {"error", "Invalid request"},
+                    {"message", "k must be between 1 and " + to_string(kMaxAlternatives)}
+                };
+                res.status = 400;
+                res.set_content(error_response.dump(), "application/json");
+                return;
+            }
+            if (time_dependent && k > 1) {
+                json error_response = {
+                    {"error", "Invalid request"},
+                    {"message", "time_dependent routes do not support k above 1"}
+                };
+                res.status = 400;
+                res.set_content(error_response.dump(), "application/json");
+                return;
+            }
             
             // Convert parameters to the format expected by the algorithms
             string time_category = timeToCategory(time);
@@ -156,13 +365,12 @@ int main() {
             string month_name = getCurrentMonth(); // Use current month
             
             // Create composite key for time-based routing
+            // The slice is passed to every search, so concurrent requests never share engine state
             array<string, 3> composite_key = {month_name, time_category, day_name};
-            
-            // Set composite key for both algorithms
-            global_dijkstra->SetCompositeKey(composite_key);
-            global_astar->SetCompositeKey(composite_key);
+            TimeSlice slice = TimeSlice::FromCompositeKey(composite_key);
             
             // Get stations by name (more robust for web app)
+            auto lookup_start_time = chrono::steady_clock::now();
             const Station* start_station_ptr = global_adj_list->GetStation(start_station);
             const Station* end_station_ptr = global_adj_list->GetStation(end_station);
             
@@ -175,26 +383,141 @@ int main() {
                 res.set_content(error_response.dump(), "application/json");
                 return;
             }
+
+            int start_id = global_adj_list->GetStationId(*start_station_ptr);
+            int end_id = global_adj_list->GetStationId(*end_station_ptr);
+            global_metrics->RecordStage(ServerMetrics::Stage::StationLookup,
+                                        ServerMetrics::NanosecondsSince(lookup_start_time));
+
+            // Alternatives come from their own engine and are not cached; the first route is the quickest
+            if (k > 1) {
+                SearchStats alternative_stats;
+                auto search_start_time = chrono::steady_clock::now();
+                auto routes = global_alternatives->GetQuickestPaths(slice, start_id, end_id, k, &alternative_stats);
+                global_metrics->RecordSearch(ServerMetrics::Algorithm::AlternativeRoutes,
+                                             ServerMetrics::NanosecondsSince(search_start_time),
+                                             alternative_stats.settled);
+
+                auto serialize_start_time = chrono::steady_clock::now();
+                json alternatives = json::array();
+                for (const auto& route : routes) {
+                    vector<string> route_stations;
+                    for (const auto& station : route.second) {
+                        route_stations.push_back(station.station_name);
+                    }
+                    alternatives.push_back({
+                        {"route", std::move(route_stations)},
+                        {"estimated_time_minutes", route.first}
+                    });
+                }
+                // Without a route the fields match a k = 1 request for an unreachable pair
+                json response = {
+                    {"route", routes.empty() ? json::array() : alternatives[0]["route"]},
+                    {"estimated_time_minutes", routes.empty() ? numeric_limits<double>::infinity() : routes[0].first},
+                    {"alternatives", std::move(alternatives)}
+                };
+                res.set_content(response.dump(), "application/json");
+                global_metrics->RecordStage(ServerMetrics::Stage::Serialization,
+                                            ServerMetrics::NanosecondsSince(serialize_start_time));
+                return;
+            }
+
+            // Time-dependent routes depend on the departure minute, so they are not cached either
+            if (time_dependent) {
+                SearchStats time_dependent_stats;
+                const int departure_minute = timeToMinutes(time);
+                auto search_start_time = chrono::steady_clock::now();
+                auto result = global_time_dependent->GetQuickestPath(slice.GetMonth(), slice.GetDayOfWeek(),
+                                                                     departure_minute, start_id, end_id,
+                                                                     &time_dependent_stats);
+                global_metrics->RecordSearch(ServerMetrics::Algorithm::TimeDependentDijkstra,
+                                             ServerMetrics::NanosecondsSince(search_start_time),
+                                             time_dependent_stats.settled);
+
+                auto serialize_start_time = chrono::steady_clock::now();
+                vector<string> route_stations;
+                for (const auto& station : result.second) {
+                    route_stations.push_back(station.station_name);
+                }
+                json response = {
+                    {"route", route_stations},
+                    {"estimated_time_minutes", result.first}
+                };
+                if (!result.second.empty()) {
+                    response["arrival_time"] = minutesToTime(departure_minute + result.first);
+                }
+                res.set_content(response.dump(), "application/json");
+                global_metrics->RecordStage(ServerMetrics::Stage::Serialization,
+                                            ServerMetrics::NanosecondsSince(serialize_start_time));
+                return;
+            }
+
+            // Serve popular pairs from the route cache
+            uint64_t cache_key = RouteCache::MakeKey(slice, start_id, end_id);
+            auto cache_start_time = chrono::steady_clock::now();
+            auto cached = global_route_cache->Get(cache_key);
+            global_metrics->RecordStage(ServerMetrics::Stage::CacheLookup, ServerMetrics::NanosecondsSince(cache_start_time));
+            if (cached) {
+                auto serialize_start_time = chrono::steady_clock::now();
+                json response = {
+                    {"route", cached->route},
+                    {"estimated_time_minutes", cached->estimated_time_minutes}
+                };
+                res.set_content(response.dump(), "application/json");
+                global_metrics->RecordStage(ServerMetrics::Stage::Serialization,
+                                            ServerMetrics::NanosecondsSince(serialize_start_time));
+                return;
+            }
+            // Taken before searching so a result computed against a graph that is reloaded meanwhile is not cached
+            uint64_t cache_generation = global_route_cache->Generation();
             
-            // Find route using both algorithms (both now return pair<double, vector<Station>>)
-            auto dijkstra_result = global_dijkstra->GetQuickestPath(*start_station_ptr, *end_station_ptr);
-            double dijkstra_time = dijkstra_result.first;
-            vector<Station> dijkstra_stations = dijkstra_result.second;
+            double total_time;
+            vector<Station> chosen_stations;
+            auto search_start_time = chrono::steady_clock::now();
+            if (global_route_table->HasSlice(slice)) {
+                // Answer from the precomputed tables: a lookup plus a walk of the next hops
+                auto table_result = global_route_table->GetQuickestPath(slice, start_id, end_id);
+                total_time = table_result.first;
+                chosen_stations = std::move(table_result.second);
+                global_metrics->RecordSearch(ServerMetrics::Algorithm::RouteTable,
+                                             ServerMetrics::NanosecondsSince(search_start_time));
+            } else if (global_hierarchy->HasSlice(slice)) {
+                // Contraction hierarchy query while the tables are still being built
+                SearchStats hierarchy_stats;
+                auto hierarchy_result = global_hierarchy->GetQuickestPath(slice, start_id, end_id, &hierarchy_stats);
+                total_time = hierarchy_result.first;
+                chosen_stations = std::move(hierarchy_result.second);
+                global_metrics->RecordSearch(ServerMetrics::Algorithm::ContractionHierarchy,
+                                             ServerMetrics::NanosecondsSince(search_start_time), hierarchy_stats.settled);
+            } else {
+                // Find route using both algorithms (both now return pair<double, vector<Station>>)
+                SearchStats dijkstra_stats;
+                auto dijkstra_result = global_dijkstra->GetQuickestPath(slice, start_id, end_id, &dijkstra_stats);
+                double dijkstra_time = dijkstra_result.first;
+                vector<Station> dijkstra_stations = dijkstra_result.second;
+                global_metrics->RecordSearch(ServerMetrics::Algorithm::Dijkstra,
+                                             ServerMetrics::NanosecondsSince(search_start_time), dijkstra_stats.settled);
             
-            auto astar_result = global_astar->GetQuickestPath(*start_station_ptr, *end_station_ptr);
-            double astar_time = astar_result.first;
-            vector<Station> astar_stations = astar_result.second;
+                auto astar_start_time = chrono::steady_clock::now();
+                SearchStats astar_stats;
+                auto astar_result = global_astar->GetQuickestPath(slice, start_id, end_id, &astar_stats);
+                double astar_time = astar_result.first;
+                global_metrics->RecordSearch(ServerMetrics::Algorithm::AStar,
+                                             ServerMetrics::NanosecondsSince(astar_start_time), astar_stats.settled);
+                vector<Station> astar_stations = astar_result.second;
             
-            // Choose the faster algorithm
-            bool use_dijkstra = (dijkstra_time <= astar_time || astar_time < 0);
-            double total_time = use_dijkstra ? dijkstra_time : astar_time;
-            vector<Station> chosen_stations = use_dijkstra ? dijkstra_stations : astar_stations;
+                // Choose the faster algorithm
+                bool use_dijkstra = (dijkstra_time <= astar_time || astar_time < 0);
+                total_time = use_dijkstra ? dijkstra_time : astar_time;
+                chosen_stations = use_dijkstra ? dijkstra_stations : astar_stations;
             
-            // Debug: Log which algorithm was faster
-            cout << "Debug: Dijkstra time: " << dijkstra_time << " min, A* time: " << astar_time << " min" << endl;
-            cout << "Debug: Using " << (use_dijkstra ? "Dijkstra" : "A*") << " algorithm" << endl;
+                // Debug: Log which algorithm was faster
+                LOG_DEBUG("Dijkstra time: " << dijkstra_time << " min, A* time: " << astar_time << " min");
+                LOG_DEBUG("Using " << (use_dijkstra ? "Dijkstra" : "A*") << " algorithm");
+            }
             
             // Convert stations to station names for the response
+            auto serialize_start_time = chrono::steady_clock::now();
             vector<string> route_stations;
             for (const auto& station : chosen_stations) {
                 route_stations.push_back(station.station_name);
@@ -205,8 +528,10 @@ int main() {
                 {"route", route_stations},
                 {"estimated_time_minutes", total_time}
             };
-            
             res.set_content(response.dump(), "application/json");
+            global_metrics->RecordStage(ServerMetrics::Stage::Serialization,
+                                        ServerMetrics::NanosecondsSince(serialize_start_time));
+            global_route_cache->Put(cache_key, CachedRoute{total_time, std::move(route_stations)}, cache_generation);
             
         } catch (const json::exception&) {
             json error_response = {
@@ -225,16 +550,413 @@ int main() {
         }
     });
 
+    // Batch route finding endpoint
+    // Queries that share a time slice and start station are answered by one one-to-many search,
+    // the groups are searched in parallel, and the results come back in request order
+    const size_t batch_max_queries = config.batch_max_queries;
+    const unsigned batch_threads = config.batch_threads;
+    svr.Post("/api/find-routes/batch", [batch_max_queries, batch_threads](const httplib::Request& req,
+                                                                           httplib::Response& res) {
+        try {
+            // Parse JSON request
+            auto parse_start_time = chrono::steady_clock::now();
+            json request = json::parse(req.body);
+            if (!request.is_object() || !request.contains("queries") || !request["queries"].is_array()) {
+                json error_response = {
+                    {"error", "Invalid request"},
+                    {"message", "Request body must have a queries array"}
+                };
+                res.status = 400;
+                res.set_content(error_response.dump(), "application/json");
+                return;
+            }
+            const json& queries = request["queries"];
+            if (queries.size() > batch_max_queries) {
+                json error_response = {
+                    {"error", "Batch too large"},
+                    {"message", "A batch may have at most " + to_string(batch_max_queries) + " queries"}
+                };
+                res.status = 413;
+                res.set_content(error_response.dump(), "application/json");
+                return;
+            }
+            global_metrics->RecordStage(ServerMetrics::Stage::JsonParse, ServerMetrics::NanosecondsSince(parse_start_time));
+
+            // The day and month are the same for the whole batch, so each hour's slice is only worked out once
+            string day_name = getCurrentDay();
+            string month_name = getCurrentMonth();
+            array<TimeSlice, 100> hour_slices;
+            array<bool, 100> hour_slice_ready{};
+
+            // Group the queries by time slice and start station
+            struct BatchGroup {
+                TimeSlice slice;
+                int start_id;
+                vector<int> end_ids;
+                vector<size_t> query_indices;  // where each end_ids result goes in the response
+            };
+            vector<BatchGroup> groups;
+            unordered_map<uint64_t, size_t> group_by_key;
+            vector<pair<double, vector<Station>>> results(queries.size());
+            // Queries that could not be searched, with the reason; empty for the rest
+            vector<string> errors(queries.size());
+
+            auto lookup_start_time = chrono::steady_clock::now();
+            const uint64_t station_count = static_cast<uint64_t>(global_adj_list->GetStationCount());
+            for (size_t i = 0; i < queries.size(); ++i) {
+                const json& query = queries[i];
+                if (!query.is_object() || !query.contains("start_station") || !query["start_station"].is_string() ||
+                    !query.contains("end_station") || !query["end_station"].is_string() ||
+                    !query.contains("time") || !query["time"].is_string()) {
+                    errors[i] = "Query needs start_station, end_station and time strings";
+                    continue;
+                }
+                const string& time = query["time"].get_ref<const string&>();
+                if (time.size() < 2 || !isdigit(static_cast<unsigned char>(time[0])) ||
+                    !isdigit(static_cast<unsigned char>(time[1]))) {
+                    errors[i] = "Time must start with a two digit hour";
+                    continue;
+                }
+                const int hour = (time[0] - '0') * 10 + (time[1] - '0');
+                if (!hour_slice_ready[hour]) {
+                    hour_slices[hour] = TimeSlice::FromCompositeKey({month_name, timeToCategory(time), day_name});
+                    hour_slice_ready[hour] = true;
+                }
+                const TimeSlice slice = hour_slices[hour];
+
+                const Station* start_station_ptr =
+                    global_adj_list->GetStation(query["start_station"].get_ref<const string&>());
+                const Station* end_station_ptr =
+                    global_adj_list->GetStation(query["end_station"].get_ref<const string&>());
+                if (!start_station_ptr || !end_station_ptr) {
+                    errors[i] = "Station not found";
+                    continue;
+                }
+                const int start_id = global_adj_list->GetStationId(*start_station_ptr);
+                const int end_id = global_adj_list->GetStationId(*end_station_ptr);
+
+                const uint64_t key = static_cast<uint64_t>(slice.Index()) * station_count + start_id;
+                auto inserted = group_by_key.emplace(key, groups.size());
+                if (inserted.second) {
+                    groups.push_back(BatchGroup{slice, start_id, {}, {}});
+                }
+                BatchGroup& group = groups[inserted.first->second];
+                group.end_ids.push_back(end_id);
+                group.query_indices.push_back(i);
+            }
+            global_metrics->RecordStage(ServerMetrics::Stage::StationLookup,
+                                        ServerMetrics::NanosecondsSince(lookup_start_time));
+
+            // Each group writes only its own queries' results, so the groups need no lock
+            ParallelFor(groups.size(), batch_threads, [&groups, &results](size_t group_index) {
+                const BatchGroup& group = groups[group_index];
+                auto search_start_time = chrono::steady_clock::now();
+                if (global_route_table->HasSlice(group.slice)) {
+                    // Table lookups need no search, so there is nothing to share within the group
+                    for (size_t k = 0; k < group.end_ids.size(); ++k) {
+                        results[group.query_indices[k]] =
+                            global_route_table->GetQuickestPath(group.slice, group.start_id, group.end_ids[k]);
+                    }
+                    global_metrics->RecordSearch(ServerMetrics::Algorithm::RouteTable,
+                                                 ServerMetrics::NanosecondsSince(search_start_time));
+                } else if (group.end_ids.size() == 1 && global_hierarchy->HasSlice(group.slice)) {
+                    // A single pair is quicker with the contraction hierarchy than with a one-to-many search
+                    SearchStats hierarchy_stats;
+                    results[group.query_indices[0]] =
+                        global_hierarchy->GetQuickestPath(group.slice, group.start_id, group.end_ids[0], &hierarchy_stats);
+                    global_metrics->RecordSearch(ServerMetrics::Algorithm::ContractionHierarchy,
+                                                 ServerMetrics::NanosecondsSince(search_start_time),
+                                                 hierarchy_stats.settled);
+                } else {
+                    SearchStats dijkstra_stats;
+                    auto paths = global_dijkstra->GetQuickestPaths(group.slice, group.start_id, group.end_ids,
+                                                                   &dijkstra_stats);
+                    for (size_t k = 0; k < paths.size(); ++k) {
+                        results[group.query_indices[k]] = std::move(paths[k]);
+                    }
+                    global_metrics->RecordSearch(ServerMetrics::Algorithm::Dijkstra,
+                                                 ServerMetrics::NanosecondsSince(search_start_time),
+                                                 dijkstra_stats.settled);
+                }
+            });
+
+            // Create response, one entry per query in request order
+            auto serialize_start_time = chrono::steady_clock::now();
+            json response_results = json::array();
+            for (size_t i = 0; i < results.size(); ++i) {
+                if (!errors[i].empty()) {
+                    response_results.push_back({{"error", errors[i]}});
+                    continue;
+                }
+                vector<string> route_stations;
+                route_stations.reserve(results[i].second.size());
+                for (const auto& station : results[i].second) {
+                    route_stations.push_back(station.station_name);
+                }
+                response_results.push_back({
+                    {"route", std::move(route_stations)},
+                    {"estimated_time_minutes", results[i].first}
+                });
+            }
+            json response = {
+                {"results", std::move(response_results)},
+                {"searches", groups.size()}
+            };
+            res.set_content(response.dump(), "application/json");
+            global_metrics->RecordStage(ServerMetrics::Stage::Serialization,
+                                        ServerMetrics::NanosecondsSince(serialize_start_time));
+
+        } catch (const json::exception&) {
+            json error_response = {
+                {"error", "Invalid JSON"},
+                {"message", "Request body must be valid JSON"}
+            };
+            res.status = 400;
+            res.set_content(error_response.dump(), "application/json");
+        } catch (const exception&) {
+            json error_response = {
+                {"error", "Internal server error"},
+                {"message", "An unexpected error occurred"}
+            };
+            res.status = 500;
+            res.set_content(error_response.dump(), "application/json");
+        }
+    });
+
+    // Travel time matrix endpoint
+    // One search per source for all targets (or bucket-based many-to-many on the contraction hierarchy),
+    // with the sources spread over threads
+    const size_t matrix_max_cells = config.matrix_max_cells;
+    svr.Post("/api/matrix", [matrix_max_cells, batch_threads](const httplib::Request& req, httplib::Response& res) {
+        auto send_error = [&res](int status, const string& error, const string& message) {
+            json error_response = {
+                {"error", error},
+                {"message", message}
+            };
+            res.status = status;
+            res.set_content(error_response.dump(), "application/json");
+        };
+        try {
+            // Parse JSON request
+            auto parse_start_time = chrono::steady_clock::now();
+            json request = json::parse(req.body);
+            auto is_string_array = [](const json& value) {
+                return value.is_array() && all_of(value.begin(), value.end(), [](const json& item) {
+                    return item.is_string();
+                });
+            };
+            if (!request.is_object() || !request.contains("sources") || !is_string_array(request["sources"]) ||
+                !request.contains("targets") || !is_string_array(request["targets"]) ||
+                !request.contains("time") || !request["time"].is_string()) {
+                send_error(400, "Invalid request", "Request body must have sources and targets arrays of station "
+                           "names and a time");
+                return;
+            }
+            const json& sources = request["sources"];
+            const json& targets = request["targets"];
+            string time = request["time"];
+            string algorithm_name = request.value("algorithm", "auto");
+            string format = request.value("format", "json");
+            if (format != "json" && format != "binary") {
+                send_error(400, "Invalid request", "format must be json or binary");
+                return;
+            }
+            if (algorithm_name != "auto" && algorithm_name != "one_to_all" && algorithm_name != "buckets") {
+                send_error(400, "Invalid request", "algorithm must be auto, one_to_all or buckets");
+                return;
+            }
+            if (time.size() < 2 || !isdigit(static_cast<unsigned char>(time[0])) ||
+                !isdigit(static_cast<unsigned char>(time[1]))) {
+                send_error(400, "Invalid request", "time must start with a two digit hour");
+                return;
+            }
+            if (sources.empty() || targets.empty() || sources.size() > matrix_max_cells / targets.size()) {
+                send_error(sources.empty() || targets.empty() ? 400 : 413, "Invalid matrix size",
+                           "A matrix needs 1 to " + to_string(matrix_max_cells) + " cells");
+                return;
+            }
+            global_metrics->RecordStage(ServerMetrics::Stage::JsonParse, ServerMetrics::NanosecondsSince(parse_start_time));
+
+            array<string, 3> composite_key = {getCurrentMonth(), timeToCategory(time), getCurrentDay()};
+            TimeSlice slice = TimeSlice::FromCompositeKey(composite_key);
+
+            // Get stations by name, reporting every name that is not a station
+            auto lookup_start_time = chrono::steady_clock::now();
+            vector<int> source_ids;
+            vector<int> target_ids;
+            vector<string> unknown_stations;
+            for (const auto& names : {make_pair(&sources, &source_ids), make_pair(&targets, &target_ids)}) {
+                names.second->reserve(names.first->size());
+                for (const auto& name : *names.first) {
+                    const Station* station = global_adj_list->GetStation(name.get_ref<const string&>());
+                    if (!station) {
+                        unknown_stations.push_back(name);
+                        continue;
+                    }
+                    names.second->push_back(global_adj_list->GetStationId(*station));
+                }
+            }
+            global_metrics->RecordStage(ServerMetrics::Stage::StationLookup,
+                                        ServerMetrics::NanosecondsSince(lookup_start_time));
+            if (!unknown_stations.empty()) {
+                json error_response = {
+                    {"error", "Station not found"},
+                    {"message", "These stations do not exist in the system"},
+                    {"stations", unknown_stations}
+                };
+                res.status = 400;
+                res.set_content(error_response.dump(), "application/json");
+                return;
+            }
+
+            // Buckets need the slice's contraction hierarchy; auto uses them once it is built
+            MatrixAlgorithm algorithm = MatrixAlgorithm::OneToAll;
+            if (algorithm_name == "buckets" || (algorithm_name == "auto" && global_matrix->HasBuckets(slice))) {
+                if (!global_matrix->HasBuckets(slice)) {
+                    send_error(503, "Not ready", "The contraction hierarchy for this time slice is not built yet");
+                    return;
+                }
+                algorithm = MatrixAlgorithm::Buckets;
+            }
+
+            vector<double> times;
+            SearchStats matrix_stats;
+            if (!global_matrix->Compute(slice, source_ids, target_ids, algorithm, times, batch_threads, &matrix_stats)) {
+                send_error(404, "No data", "There are no travel times for this time slice");
+                return;
+            }
+
+            auto serialize_start_time = chrono::steady_clock::now();
+            const char* used_algorithm = algorithm == MatrixAlgorithm::Buckets ? "buckets" : "one_to_all";
+            if (format == "binary") {
+                res.set_header("X-Matrix-Algorithm", used_algorithm);
+                res.set_content(encodeMatrixBinary(static_cast<uint32_t>(source_ids.size()),
+                                                   static_cast<uint32_t>(target_ids.size()), times),
+                                "application/octet-stream");
+            } else {
+                // One row per source; unreachable targets are null
+                json rows = json::array();
+                for (size_t row = 0; row < source_ids.size(); ++row) {
+                    rows.push_back(vector<double>(times.begin() + row * target_ids.size(),
+                                                  times.begin() + (row + 1) * target_ids.size()));
+                }
+                json response = {
+                    {"sources", sources},
+                    {"targets", targets},
+                    {"times_minutes", std::move(rows)},
+                    {"algorithm", used_algorithm},
+                    {"settled_stations", matrix_stats.settled}
+                };
+                res.set_content(response.dump(), "application/json");
+            }
+            global_metrics->RecordStage(ServerMetrics::Stage::Serialization,
+                                        ServerMetrics::NanosecondsSince(serialize_start_time));
+
+        } catch (const json::exception&) {
+            send_error(400, "Invalid JSON", "Request body must be valid JSON");
+        } catch (const exception&) {
+            send_error(500, "Internal server error", "An unexpected error occurred");
+        }
+    });
+
+    // Isochrone endpoint
+    // Every station reachable within a time budget, from one bounded search on the worker thread's search state
+    svr.Post("/api/isochrone", [](const httplib::Request& req, httplib::Response& res) {
+        auto send_error = [&res](int status, const string& error, const string& message) {
+            json error_response = {
+                {"error", error},
+                {"message", message}
+            };
+            res.status = status;
+            res.set_content(error_response.dump(), "application/json");
+        };
+        try {
+            // Parse JSON request
+            auto parse_start_time = chrono::steady_clock::now();
+            json request = json::parse(req.body);
+            if (!request.is_object() || !request.contains("start_station") || !request["start_station"].is_string() ||
+                !request.contains("time") || !request["time"].is_string() ||
+                !request.contains("max_minutes") || !request["max_minutes"].is_number()) {
+                send_error(400, "Invalid request", "Request body must have start_station, time and max_minutes");
+                return;
+            }
+            string start_station = request["start_station"];
+            string time = request["time"];
+            double max_minutes = request["max_minutes"];
+            if (time.size() < 2 || !isdigit(static_cast<unsigned char>(time[0])) ||
+                !isdigit(static_cast<unsigned char>(time[1]))) {
+                send_error(400, "Invalid request", "time must start with a two digit hour");
+                return;
+            }
+            if (!(max_minutes >= 0)) {
+                send_error(400, "Invalid request", "max_minutes must not be negative");
+                return;
+            }
+            global_metrics->RecordStage(ServerMetrics::Stage::JsonParse, ServerMetrics::NanosecondsSince(parse_start_time));
+
+            array<string, 3> composite_key = {getCurrentMonth(), timeToCategory(time), getCurrentDay()};
+            TimeSlice slice = TimeSlice::FromCompositeKey(composite_key);
+
+            auto lookup_start_time = chrono::steady_clock::now();
+            const Station* start_station_ptr = global_adj_list->GetStation(start_station);
+            if (!start_station_ptr) {
+                send_error(400, "Station not found", "The start station does not exist in the system");
+                return;
+            }
+            int start_id = global_adj_list->GetStationId(*start_station_ptr);
+            global_metrics->RecordStage(ServerMetrics::Stage::StationLookup,
+                                        ServerMetrics::NanosecondsSince(lookup_start_time));
+
+            // Kept per worker thread, like the search state, so a repeated query does not allocate to search
+            thread_local vector<pair<int, double>> reachable;
+            SearchStats isochrone_stats;
+            auto search_start_time = chrono::steady_clock::now();
+            if (!global_dijkstra->GetReachableStations(slice, start_id, max_minutes, reachable, &isochrone_stats)) {
+                send_error(404, "No data", "There are no travel times for this time slice");
+                return;
+            }
+            global_metrics->RecordSearch(ServerMetrics::Algorithm::Dijkstra,
+                                         ServerMetrics::NanosecondsSince(search_start_time), isochrone_stats.settled);
+
+            // Stations by increasing arrival time, the start first
+            auto serialize_start_time = chrono::steady_clock::now();
+            json stations = json::array();
+            for (const auto& entry : reachable) {
+                const Station* station = global_adj_list->GetStation(entry.first);
+                stations.push_back({
+                    {"station", station->station_name},
+                    {"coordinates", {station->coordinates.first, station->coordinates.second}},
+                    {"time_minutes", entry.second}
+                });
+            }
+            json response = {
+                {"start_station", start_station},
+                {"max_minutes", max_minutes},
+                {"stations", std::move(stations)}
+            };
+            res.set_content(response.dump(), "application/json");
+            global_metrics->RecordStage(ServerMetrics::Stage::Serialization,
+                                        ServerMetrics::NanosecondsSince(serialize_start_time));
+
+        } catch (const json::exception&) {
+            send_error(400, "Invalid JSON", "Request body must be valid JSON");
+        } catch (const exception&) {
+            send_error(500, "Internal server error", "An unexpected error occurred");
+        }
+    });
+
     // Algorithm comparison endpoint
     svr.Post("/api/compare-algorithms", [](const httplib::Request& req, httplib::Response& res) {
         try {
             // Parse JSON request
+            auto parse_start_time = chrono::steady_clock::now();
             json request = json::parse(req.body);
             
             // Extract parameters
             string start_station = request["start_station"];
             string end_station = request["end_station"];
             string time = request["time"];
+            global_metrics->RecordStage(ServerMetrics::Stage::JsonParse, ServerMetrics::NanosecondsSince(parse_start_time));
             
             // Convert parameters to the format expected by the algorithms
             string time_category = timeToCategory(time);
@@ -242,13 +964,12 @@ int main() {
             string month_name = getCurrentMonth(); // Use current month
             
             // Create composite key for time-based routing
+            // The slice is passed to every search, so concurrent requests never share engine state
             array<string, 3> composite_key = {month_name, time_category, day_name};
-            
-            // Set composite key for both algorithms
-            global_dijkstra->SetCompositeKey(composite_key);
-            global_astar->SetCompositeKey(composite_key);
+            TimeSlice slice = TimeSlice::FromCompositeKey(composite_key);
             
             // Get stations by name
+            auto lookup_start_time = chrono::steady_clock::now();
             const Station* start_station_ptr = global_adj_list->GetStation(start_station);
             const Station* end_station_ptr = global_adj_list->GetStation(end_station);
             
@@ -261,28 +982,58 @@ int main() {
                 res.set_content(error_response.dump(), "application/json");
                 return;
             }
+
+            int start_id = global_adj_list->GetStationId(*start_station_ptr);
+            int end_id = global_adj_list->GetStationId(*end_station_ptr);
+            global_metrics->RecordStage(ServerMetrics::Stage::StationLookup,
+                                        ServerMetrics::NanosecondsSince(lookup_start_time));
             
             // Get current time for execution timing
             auto start_time = chrono::high_resolution_clock::now();
             
             // Run Dijkstra's algorithm
-            auto dijkstra_result = global_dijkstra->GetQuickestPath(*start_station_ptr, *end_station_ptr);
+            SearchStats dijkstra_stats;
+            RecordingTrace dijkstra_trace;
+            auto dijkstra_result = global_dijkstra->GetQuickestPath(slice, start_id, end_id, dijkstra_trace, &dijkstra_stats);
             double dijkstra_time = dijkstra_result.first;
             vector<Station> dijkstra_stations = dijkstra_result.second;
             
             auto dijkstra_end_time = chrono::high_resolution_clock::now();
             auto dijkstra_execution_time = chrono::duration_cast<chrono::microseconds>(dijkstra_end_time - start_time).count();
+            global_metrics->RecordSearch(ServerMetrics::Algorithm::Dijkstra,
+                                         chrono::duration_cast<chrono::nanoseconds>(dijkstra_end_time - start_time).count(),
+                                         dijkstra_stats.settled);
             
             // Run A* algorithm
             auto astar_start_time = chrono::high_resolution_clock::now();
-            auto astar_result = global_astar->GetQuickestPath(*start_station_ptr, *end_station_ptr);
+            SearchStats astar_stats;
+            RecordingTrace astar_trace;
+            auto astar_result = global_astar->GetQuickestPath(slice, start_id, end_id, astar_trace, &astar_stats);
             double astar_time = astar_result.first;
             vector<Station> astar_stations = astar_result.second;
             
             auto astar_end_time = chrono::high_resolution_clock::now();
             auto astar_execution_time = chrono::duration_cast<chrono::microseconds>(astar_end_time - astar_start_time).count();
+            global_metrics->RecordSearch(ServerMetrics::Algorithm::AStar,
+                                         chrono::duration_cast<chrono::nanoseconds>(astar_end_time - astar_start_time).count(),
+                                         astar_stats.settled);
+
+            // Run bidirectional Dijkstra
+            auto bidirectional_start_time = chrono::high_resolution_clock::now();
+            SearchStats bidirectional_stats;
+            RecordingTrace bidirectional_trace;
+            auto bidirectional_result = global_bidirectional->GetQuickestPath(slice, start_id, end_id, bidirectional_trace, &bidirectional_stats);
+            double bidirectional_time = bidirectional_result.first;
+            vector<Station> bidirectional_stations = bidirectional_result.second;
+
+            auto bidirectional_end_time = chrono::high_resolution_clock::now();
+            auto bidirectional_execution_time = chrono::duration_cast<chrono::microseconds>(bidirectional_end_time - bidirectional_start_time).count();
+            global_metrics->RecordSearch(ServerMetrics::Algorithm::BidirectionalDijkstra,
+                                         chrono::duration_cast<chrono::nanoseconds>(bidirectional_end_time - bidirectional_start_time).count(),
+                                         bidirectional_stats.settled);
             
             // Convert stations to station names
+            auto serialize_start_time = chrono::steady_clock::now();
             vector<string> dijkstra_route;
             for (const auto& station : dijkstra_stations) {
                 dijkstra_route.push_back(station.station_name);
@@ -292,10 +1043,16 @@ int main() {
             for (const auto& station : astar_stations) {
                 astar_route.push_back(station.station_name);
             }
+
+            vector<string> bidirectional_route;
+            for (const auto& station : bidirectional_stations) {
+                bidirectional_route.push_back(station.station_name);
+            }
             
-            // Generate exploration steps (simulated based on route)
-            vector<string> dijkstra_exploration = generateExplorationSteps(dijkstra_route, true);
-            vector<string> astar_exploration = generateExplorationSteps(astar_route, false);
+            // Stations each search settled, in the order it settled them
+            vector<string> dijkstra_exploration = getExplorationSteps(dijkstra_trace);
+            vector<string> astar_exploration = getExplorationSteps(astar_trace);
+            vector<string> bidirectional_exploration = getExplorationSteps(bidirectional_trace);
             
             // Determine winner
             string winner = "tie";
@@ -316,6 +1073,9 @@ int main() {
             int exploration_difference = astar_exploration.size() - dijkstra_exploration.size();
             double efficiency_ratio = (dijkstra_execution_time > 0) ? 
                 (double)astar_execution_time / dijkstra_execution_time : 1.0;
+            // Share of Dijkstra's search space the bidirectional search settled
+            double bidirectional_settled_ratio = (dijkstra_stats.settled > 0) ?
+                (double)bidirectional_stats.settled / dijkstra_stats.settled : 1.0;
             
             // Create response
             json response = {
@@ -323,27 +1083,44 @@ int main() {
                     {"route", dijkstra_route},
                     {"estimated_time_minutes", dijkstra_time},
                     {"stations_explored", dijkstra_exploration.size()},
+                    {"settled_stations", dijkstra_stats.settled},
                     {"execution_time_ms", dijkstra_execution_time / 1000.0},
                     {"exploration_steps", dijkstra_exploration},
+                    {"search_trace", getTraceCounts(dijkstra_trace)},
                     {"algorithm", "dijkstra"}
                 }},
                 {"astar", {
                     {"route", astar_route},
                     {"estimated_time_minutes", astar_time},
                     {"stations_explored", astar_exploration.size()},
+                    {"settled_stations", astar_stats.settled},
                     {"execution_time_ms", astar_execution_time / 1000.0},
                     {"exploration_steps", astar_exploration},
+                    {"search_trace", getTraceCounts(astar_trace)},
                     {"algorithm", "astar"}
                 }},
+                {"bidirectional_dijkstra", {
+                    {"route", bidirectional_route},
+                    {"estimated_time_minutes", bidirectional_time},
+                    {"stations_explored", bidirectional_exploration.size()},
+                    {"settled_stations", bidirectional_stats.settled},
+                    {"execution_time_ms", bidirectional_execution_time / 1000.0},
+                    {"exploration_steps", bidirectional_exploration},
+                    {"search_trace", getTraceCounts(bidirectional_trace)},
+                    {"algorithm", "bidirectional_dijkstra"}
+                }},
                 {"winner", winner},
                 {"performance_metrics", {
                     {"time_difference", time_difference},
                     {"exploration_difference", exploration_difference},
-                    {"efficiency_ratio", efficiency_ratio}
+                    {"efficiency_ratio", efficiency_ratio},
+                    {"bidirectional_settled_ratio", bidirectional_settled_ratio}
                 }}
             };
             
             res.set_content(response.dump(), "application/json");
+            global_metrics->RecordStage(ServerMetrics::Stage::Serialization,
+                                        ServerMetrics::NanosecondsSince(serialize_start_time));
             
         } catch (const json::exception&) {
             json error_response = {
@@ -363,8 +1140,9 @@ int main() {
     });
 
     // Start the server
-    if (!svr.listen("localhost", 8080)) {
-        cerr << "Failed to start server!" << endl;
+    if (!svr.listen(config.host, config.port)) {
+        LOG_ERROR("Failed to start server!");
+        Logger::Instance().Flush();
         return 1;
     }
 
@@ -1,9 +1,35 @@
 #include <catch2/catch_test_macros.hpp>
+#include <catch2/catch_approx.hpp>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
 #include <iostream>
+#include <stdexcept>
+#include <thread>
 
 #include "../include/AdjacencyList.h"
+#include "../include/AlternativeRoutes.h"
 #include "../include/Dijkstra.h"
 #include "../include/AStar.h"
+#include "../include/BidirectionalDijkstra.h"
+#include "../include/ContractionHierarchy.h"
+#include "../include/DistanceMatrix.h"
+#include "../include/GraphSnapshot.h"
+#include "../include/LandmarkTable.h"
+#include "../include/LatencyHistogram.h"
+#include "../include/Logger.h"
+#include "../include/ParallelFor.h"
+#include "../include/PriorityQueue.h"
+#include "../include/RouteCache.h"
+#include "../include/SearchTrace.h"
+#include "../include/ServerConfig.h"
+#include "../include/ServerMetrics.h"
+#include "../include/ShortestPathTable.h"
+#include "../include/TimeDependentDijkstra.h"
 
 AdjacencyList adj_list;
 Dijkstra dijkstra(&adj_list);
@@ -31,4 +57,1067 @@ TEST_CASE("Single-Edge Search A*", "[astar]") {
   std::pair<double, std::vector<Station>> expected_output{1.37, std::vector<Station>{start_station, end_station}};
   REQUIRE(quickest_path.first == expected_output.first);
   REQUIRE(quickest_path.second == expected_output.second);
-}
\ No newline at end of file
+}
+
+TEST_CASE("Memory-Mapped CSV Loader Matches Stream Loader", "[adjacency_list]") {
+  AdjacencyList stream_list;
+  stream_list.LoadFromCSV("../data/subway_travel_times.csv", CsvLoadMode::Stream);
+  AdjacencyList mapped_list;
+  mapped_list.LoadFromCSV("../data/subway_travel_times.csv", CsvLoadMode::Mapped);
+
+  REQUIRE(stream_list.GetStationCount() > 0);
+  REQUIRE(mapped_list.GetStationCount() == stream_list.GetStationCount());
+  REQUIRE(mapped_list == stream_list);
+}
+
+TEST_CASE("Parallel CSV Loader Matches Stream Loader", "[adjacency_list]") {
+  AdjacencyList stream_list;
+  stream_list.LoadFromCSV("../data/subway_travel_times.csv", CsvLoadMode::Stream);
+
+  // Station IDs and edge order must not depend on how the file is split
+  for (unsigned int thread_count : {1u, 3u, 8u}) {
+    AdjacencyList parallel_list;
+    parallel_list.LoadFromCSV("../data/subway_travel_times.csv", CsvLoadMode::Parallel, thread_count);
+    REQUIRE(parallel_list == stream_list);
+  }
+}
+
+TEST_CASE("Binary Snapshot Round Trip", "[adjacency_list]") {
+  AdjacencyList csv_list;
+  csv_list.LoadFromCSV("../data/subway_travel_times.csv", CsvLoadMode::Mapped);
+  REQUIRE(csv_list.SaveSnapshot("subway_travel_times.snapshot"));
+
+  AdjacencyList snapshot_list;
+  REQUIRE(snapshot_list.LoadFromSnapshot("subway_travel_times.snapshot"));
+  REQUIRE(snapshot_list == csv_list);
+  // The snapshot only holds CSR graphs; the adjacency lists come back from them
+  const std::array<std::string, 3> composite_key{"August", "early_morning", "Saturday"};
+  REQUIRE(*snapshot_list.GetAdjacencyList(composite_key) == *csv_list.GetAdjacencyList(composite_key));
+
+  // Writing a new snapshot replaces the file instead of overwriting the one snapshot_list still maps
+  REQUIRE(csv_list.SaveSnapshot("subway_travel_times.snapshot"));
+
+  // A snapshot stamped with its CSV is rejected once the CSV changes
+  const std::string source_path = "snapshot_source.csv";
+  {
+    std::ifstream source("../data/subway_travel_times.csv", std::ios::binary);
+    std::ofstream copy(source_path, std::ios::binary);
+    copy << source.rdbuf();
+  }
+  REQUIRE(csv_list.SaveSnapshot("source_stamped.snapshot", source_path));
+  AdjacencyList stamped_list;
+  REQUIRE(stamped_list.LoadFromSnapshot("source_stamped.snapshot", source_path));
+  {
+    std::ofstream copy(source_path, std::ios::binary | std::ios::app);
+    copy << "\n";
+  }
+  AdjacencyList stale_list;
+  REQUIRE_FALSE(stale_list.LoadFromSnapshot("source_stamped.snapshot", source_path));
+  REQUIRE(stale_list.GetStationCount() == 0);
+  std::remove(source_path.c_str());
+  std::remove("source_stamped.snapshot");
+
+  // Two records for one composite key are rejected, even with a valid checksum
+  {
+    std::fstream file("subway_travel_times.snapshot", std::ios::in | std::ios::out | std::ios::binary);
+    graph_snapshot::Header header{};
+    file.read(reinterpret_cast<char*>(&header), sizeof(header));
+    std::string payload(header.payload_size, '\0');
+    file.read(&payload[0], static_cast<std::streamsize>(payload.size()));
+    REQUIRE(header.key_count >= 2);
+    const std::size_t keys_pos = (header.station_count * sizeof(graph_snapshot::StationRecord) + 7) / 8 * 8;
+    auto* keys = reinterpret_cast<graph_snapshot::KeyRecord*>(&payload[keys_pos]);
+    std::memcpy(keys[1].field_offsets, keys[0].field_offsets, sizeof(keys[0].field_offsets));
+    std::memcpy(keys[1].field_lengths, keys[0].field_lengths, sizeof(keys[0].field_lengths));
+    header.payload_checksum = graph_snapshot::Checksum(payload.data(), payload.size());
+    file.seekp(0);
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file.write(payload.data(), static_cast<std::streamsize>(payload.size()));
+  }
+  AdjacencyList duplicate_list;
+  REQUIRE_FALSE(duplicate_list.LoadFromSnapshot("subway_travel_times.snapshot"));
+  REQUIRE(duplicate_list.GetStationCount() == 0);
+  REQUIRE(csv_list.SaveSnapshot("subway_travel_times.snapshot"));
+
+  // Flip one payload byte and the checksum must reject the file
+  {
+    std::fstream file("subway_travel_times.snapshot", std::ios::in | std::ios::out | std::ios::binary);
+    file.seekg(100);
+    char byte = 0;
+    file.read(&byte, 1);
+    byte = static_cast<char>(~byte);
+    file.seekp(100);
+    file.write(&byte, 1);
+  }
+  AdjacencyList corrupt_list;
+  REQUIRE_FALSE(corrupt_list.LoadFromSnapshot("subway_travel_times.snapshot"));
+  REQUIRE(corrupt_list.GetStationCount() == 0);
+
+  // An edge count whose section sizes wrap to 0 must not pass the bounds check; the header is not checksummed
+  REQUIRE(csv_list.SaveSnapshot("subway_travel_times.snapshot"));
+  {
+    std::fstream file("subway_travel_times.snapshot", std::ios::in | std::ios::out | std::ios::binary);
+    const std::uint64_t edge_count = 1ULL << 62;
+    file.seekp(offsetof(graph_snapshot::Header, edge_count));
+    file.write(reinterpret_cast<const char*>(&edge_count), sizeof(edge_count));
+  }
+  REQUIRE_FALSE(corrupt_list.LoadFromSnapshot("subway_travel_times.snapshot"));
+  REQUIRE(corrupt_list.GetStationCount() == 0);
+  std::remove("subway_travel_times.snapshot");
+
+  // The first snapshot's graphs still read the file they were loaded from
+  REQUIRE(snapshot_list == csv_list);
+}
+
+TEST_CASE("CSR Graph Matches Adjacency List", "[adjacency_list]") {
+  AdjacencyList csr_list;
+  csr_list.LoadFromCSV("../data/subway_travel_times.csv", CsvLoadMode::Mapped);
+  const std::array<std::string, 3> composite_key{"August", "early_morning", "Saturday"};
+  auto* adjacency = csr_list.GetAdjacencyList(composite_key);
+  const CsrGraph* graph = csr_list.GetCsrGraph(composite_key);
+  REQUIRE(adjacency != nullptr);
+  REQUIRE(graph != nullptr);
+  REQUIRE(graph->StationCount() == csr_list.GetStationCount());
+
+  // Every station's CSR range must hold the same edges in the same order as its adjacency vector
+  for (int station_id = 0; station_id < graph->StationCount(); ++station_id) {
+    std::vector<Edge> csr_edges;
+    for (int edge = graph->offsets[station_id]; edge < graph->offsets[station_id + 1]; ++edge) {
+      csr_edges.push_back(Edge{station_id, graph->targets[edge], graph->weights[edge]});
+    }
+    auto it = adjacency->find(station_id);
+    REQUIRE(csr_edges == (it == adjacency->end() ? std::vector<Edge>{} : it->second));
+  }
+  REQUIRE(csr_list.GetCsrGraph({"August", "not_a_time", "Saturday"}) == nullptr);
+}
+
+TEST_CASE("Time Slice Keys", "[time_slice]") {
+  const TimeSlice slice(Month::August, TimeOfDay::EarlyMorning, DayOfWeek::Saturday);
+  REQUIRE(slice.IsValid());
+  REQUIRE(slice.ToCompositeKey() == std::array<std::string, 3>{"August", "early_morning", "Saturday"});
+  REQUIRE(TimeSlice::FromCompositeKey({"August", "early_morning", "Saturday"}) == slice);
+  REQUIRE(TimeSlice::FromIndex(slice.Index()) == slice);
+  REQUIRE_FALSE(TimeSlice::FromCompositeKey({"August", "lunch", "Saturday"}).IsValid());
+
+  // Every slice index maps back to the same month, time of day, and day of week
+  for (int index = 0; index < TimeSlice::kCount; ++index) {
+    const TimeSlice from_index = TimeSlice::FromIndex(index);
+    REQUIRE(TimeSlice(from_index.GetMonth(), from_index.GetTimeOfDay(), from_index.GetDayOfWeek()).Index() == index);
+  }
+
+  // The slice accessor and the string adapter return the same graph
+  AdjacencyList slice_list;
+  slice_list.LoadFromCSV("../data/subway_travel_times.csv", CsvLoadMode::Mapped);
+  REQUIRE(slice_list.GetCsrGraph(slice) != nullptr);
+  REQUIRE(slice_list.GetCsrGraph(slice) == slice_list.GetCsrGraph({"August", "early_morning", "Saturday"}));
+  REQUIRE(slice_list.GetCsrGraph(TimeSlice()) == nullptr);
+}
+
+TEST_CASE("Dijkstra Reuses Search State Across Queries", "[dijkstra]") {
+  AdjacencyList state_list;
+  state_list.LoadFromCSV("../data/subway_travel_times.csv", CsvLoadMode::Mapped);
+  Dijkstra reused(&state_list);
+  reused.SetCompositeKey({"August", "evening_rush", "Monday"});
+
+  // A long-lived engine must answer every query exactly like a freshly constructed one
+  for (int start_id = 0; start_id < state_list.GetStationCount(); start_id += 37) {
+    for (int end_id = 0; end_id < state_list.GetStationCount(); end_id += 53) {
+      Dijkstra fresh(&state_list);
+      fresh.SetCompositeKey({"August", "evening_rush", "Monday"});
+      const Station& start_station = *state_list.GetStation(start_id);
+      const Station& end_station = *state_list.GetStation(end_id);
+      REQUIRE(reused.GetQuickestPath(start_station, end_station) == fresh.GetQuickestPath(start_station, end_station));
+    }
+  }
+}
+
+TEST_CASE("One-To-Many Dijkstra Matches Pairwise Searches", "[dijkstra]") {
+  AdjacencyList adj_list;
+  adj_list.LoadFromCSV("../data/subway_travel_times.csv");
+  Dijkstra dijkstra(&adj_list);
+  const TimeSlice slice = adj_list.GetTimeSlices().front();
+  const int station_count = adj_list.GetStationCount();
+
+  // Targets in any order, repeated, and including the start station itself
+  for (int start_id = 0; start_id < station_count; start_id += 41) {
+    std::vector<int> end_ids = {start_id, station_count - 1};
+    for (int end_id = 3; end_id < station_count; end_id += 29) {
+      end_ids.push_back(end_id);
+    }
+    end_ids.push_back(end_ids[2]);
+
+    SearchStats many_stats;
+    auto results = dijkstra.GetQuickestPaths(slice, start_id, end_ids, &many_stats);
+    REQUIRE(results.size() == end_ids.size());
+    std::uint64_t pairwise_settled = 0;
+    for (std::size_t i = 0; i < end_ids.size(); ++i) {
+      SearchStats pair_stats;
+      REQUIRE(results[i] == dijkstra.GetQuickestPath(slice, start_id, end_ids[i], &pair_stats));
+      pairwise_settled += pair_stats.settled;
+    }
+    // One search does the work of all the pairwise ones
+    REQUIRE(many_stats.settled <= pairwise_settled);
+  }
+
+  // Bad stations and slices get the same sentinel as a single search, without upsetting the valid targets
+  auto mixed = dijkstra.GetQuickestPaths(slice, 0, {-1, 1, station_count});
+  REQUIRE(mixed[0].first == -1);
+  REQUIRE(mixed[1] == dijkstra.GetQuickestPath(slice, 0, 1));
+  REQUIRE(mixed[2].first == -1);
+  REQUIRE(dijkstra.GetQuickestPaths(TimeSlice(), 0, {1})[0].first == -1);
+  REQUIRE(dijkstra.GetQuickestPaths(slice, station_count, {1})[0].first == -1);
+  REQUIRE(dijkstra.GetQuickestPaths(slice, 0, {}).empty());
+}
+
+TEST_CASE("Bounded Dijkstra Finds Every Station Within The Budget", "[dijkstra][isochrone]") {
+  AdjacencyList adj_list;
+  adj_list.LoadFromCSV("../data/subway_travel_times.csv");
+  Dijkstra dijkstra(&adj_list);
+  const TimeSlice slice = adj_list.GetTimeSlices().front();
+  const int station_count = adj_list.GetStationCount();
+
+  std::vector<std::pair<int, double>> reachable;
+  for (int start_id = 0; start_id < station_count; start_id += 23) {
+    for (double budget : {0.0, 5.0, 20.0, 1e9}) {
+      SearchStats stats;
+      REQUIRE(dijkstra.GetReachableStations(slice, start_id, budget, reachable, &stats));
+      REQUIRE(reachable.front() == std::make_pair(start_id, 0.0));
+      REQUIRE(stats.settled == reachable.size());
+      REQUIRE(std::is_sorted(reachable.begin(), reachable.end(),
+                             [](const auto& a, const auto& b) { return a.second < b.second; }));
+
+      // Exactly the stations whose quickest time fits the budget, at that time
+      std::vector<double> times(station_count, -1);
+      for (const auto& entry : reachable) {
+        REQUIRE(times[entry.first] == -1);
+        times[entry.first] = entry.second;
+      }
+      for (int end_id = 0; end_id < station_count; ++end_id) {
+        const double expected = dijkstra.GetQuickestPath(slice, start_id, end_id).first;
+        if (expected <= budget) {
+          REQUIRE(times[end_id] == expected);
+        } else {
+          REQUIRE(times[end_id] == -1);
+        }
+      }
+    }
+  }
+
+  // A caller that keeps the vector does not reallocate it
+  const auto capacity = reachable.capacity();
+  const auto* data = reachable.data();
+  REQUIRE(dijkstra.GetReachableStations(slice, 0, 20.0, reachable));
+  REQUIRE(reachable.capacity() == capacity);
+  REQUIRE(reachable.data() == data);
+
+  REQUIRE_FALSE(dijkstra.GetReachableStations(slice, station_count, 20.0, reachable));
+  REQUIRE(reachable.empty());
+  REQUIRE_FALSE(dijkstra.GetReachableStations(slice, 0, -1.0, reachable));
+  REQUIRE_FALSE(dijkstra.GetReachableStations(TimeSlice(), 0, 20.0, reachable));
+}
+
+TEST_CASE("Alternative Routes Are The K Quickest Loopless Paths", "[alternative_routes][dijkstra]") {
+  // A -> D directly (5), through B (2), through C (3) and through B then C (3.5); C -> A would make loops
+  const std::string csv_path = "alternative_routes_test.csv";
+  {
+    std::ofstream csv(csv_path);
+    csv << "month,time_of_day,day_of_week,start_station,start_lat,start_lon,end_station,end_lat,end_lon,avg_travel_time\n";
+    const char* edges[][3] = {{"A", "B", "1"}, {"B", "D", "1"}, {"A", "C", "1"}, {"C", "D", "2"},
+                              {"A", "D", "5"}, {"B", "C", "0.5"}, {"C", "A", "0.1"}};
+    // A station is its name and coordinates, so each name keeps one position
+    auto position = [](const char* name) { return ",40." + std::to_string(name[0] - 'A') + ",-73.0,"; };
+    for (const auto& edge : edges) {
+      csv << "July,midday,Monday," << edge[0] << position(edge[0]) << edge[1] << position(edge[1]) << edge[2] << "\n";
+    }
+  }
+  AdjacencyList small_list;
+  small_list.LoadFromCSV(csv_path);
+  std::remove(csv_path.c_str());
+  const TimeSlice small_slice = TimeSlice::FromCompositeKey({"July", "midday", "Monday"});
+  auto id = [&small_list](const char* name) { return small_list.GetStationId(*small_list.GetStation(name)); };
+
+  AlternativeRoutes small_routes(&small_list);
+  auto routes = small_routes.GetQuickestPaths(small_slice, id("A"), id("D"), 10);
+  const std::vector<std::pair<double, std::vector<std::string>>> expected = {
+      {2.0, {"A", "B", "D"}}, {3.0, {"A", "C", "D"}}, {3.5, {"A", "B", "C", "D"}}, {5.0, {"A", "D"}}};
+  REQUIRE(routes.size() == expected.size());
+  for (std::size_t i = 0; i < expected.size(); ++i) {
+    REQUIRE(routes[i].first == Catch::Approx(expected[i].first));
+    std::vector<std::string> names;
+    for (const auto& station : routes[i].second) {
+      names.push_back(station.station_name);
+    }
+    REQUIRE(names == expected[i].second);
+  }
+  REQUIRE(small_routes.GetQuickestPaths(small_slice, id("A"), id("D"), 2).size() == 2);
+  REQUIRE(small_routes.GetQuickestPaths(small_slice, id("D"), id("A"), 3).empty());
+  REQUIRE(small_routes.GetQuickestPaths(small_slice, id("A"), id("A"), 3).size() == 1);
+  REQUIRE(small_routes.GetQuickestPaths(TimeSlice(), id("A"), id("D"), 3).empty());
+
+  // On the real network: the first route is Dijkstra's, and every route is distinct, loopless and no quicker
+  AdjacencyList adj_list;
+  adj_list.LoadFromCSV("../data/subway_travel_times.csv");
+  Dijkstra dijkstra(&adj_list);
+  AlternativeRoutes alternatives(&adj_list);
+  const TimeSlice slice = adj_list.GetTimeSlices().front();
+  const int station_count = adj_list.GetStationCount();
+  for (int start_id = 0; start_id < station_count; start_id += 43) {
+    for (int end_id = 7; end_id < station_count; end_id += 59) {
+      auto quickest = dijkstra.GetQuickestPath(slice, start_id, end_id);
+      SearchStats stats;
+      auto found = alternatives.GetQuickestPaths(slice, start_id, end_id, 4, &stats);
+      if (quickest.second.empty()) {
+        REQUIRE(found.empty());
+        continue;
+      }
+      REQUIRE_FALSE(found.empty());
+      REQUIRE(found.front().first == Catch::Approx(quickest.first).epsilon(1e-12));
+      // Paths are converted like every other engine's, so the first route reads like Dijkstra's
+      REQUIRE(found.front().second == quickest.second);
+      for (std::size_t i = 0; i < found.size(); ++i) {
+        const auto& path = found[i].second;
+        REQUIRE(path.front().station_name == adj_list.GetStation(start_id)->station_name);
+        REQUIRE(path.back().station_name == adj_list.GetStation(end_id)->station_name);
+        std::vector<std::string> names;
+        for (const auto& station : path) {
+          names.push_back(station.station_name);
+        }
+        std::sort(names.begin(), names.end());
+        REQUIRE(std::adjacent_find(names.begin(), names.end()) == names.end());
+        if (i > 0) {
+          REQUIRE(found[i].first >= found[i - 1].first);
+          REQUIRE_FALSE(path == found[i - 1].second);
+        }
+      }
+    }
+  }
+}
+
+TEST_CASE("Time-Dependent Dijkstra Prices Edges At Arrival Time", "[time_dependent][dijkstra]") {
+  // A -> B takes 10 in the morning rush, 2 at midday, 6 on Monday evening and 4 early on Tuesday; B -> C runs at
+  // midday only, so earlier travellers wait for 09:00. D -> E drops from 600 in Sunday's evening rush to 10 late
+  // on Sunday and early on Monday, faster than the clock runs
+  const std::string csv_path = "time_dependent_test.csv";
+  {
+    std::ofstream csv(csv_path);
+    csv << "month,time_of_day,day_of_week,start_station,start_lat,start_lon,end_station,end_lat,end_lon,avg_travel_time\n";
+    const char* edges[][5] = {{"morning_rush", "Monday", "A", "B", "10"}, {"midday", "Monday", "A", "B", "2"},
+                              {"evening", "Monday", "A", "B", "6"},       {"early_morning", "Tuesday", "A", "B", "4"},
+                              {"midday", "Monday", "B", "C", "1"},        {"evening_rush", "Sunday", "D", "E", "600"},
+                              {"evening", "Sunday", "D", "E", "10"},      {"early_morning", "Monday", "D", "E", "10"}};
+    auto position = [](const char* name) { return ",40." + std::to_string(name[0] - 'A') + ",-73.0,"; };
+    for (const auto& edge : edges) {
+      csv << "July," << edge[0] << "," << edge[1] << "," << edge[2] << position(edge[2]) << edge[3]
+          << position(edge[3]) << edge[4] << "\n";
+    }
+  }
+  AdjacencyList small_list;
+  small_list.LoadFromCSV(csv_path);
+  std::remove(csv_path.c_str());
+  auto id = [&small_list](const char* name) { return small_list.GetStationId(*small_list.GetStation(name)); };
+
+  TimeDependentDijkstra small_engine(&small_list);
+  small_engine.Build();
+  // Leaving at 08:55, A -> B is interpolated from the morning rush midpoint (07:00) towards midday's (12:30), and
+  // B is reached at midday when B -> C runs; the morning rush slice alone has no B -> C
+  const double a_to_b = 10 + (2 - 10) * (535.0 - 420) / (750 - 420);
+  auto crossing = small_engine.GetQuickestPath(Month::July, DayOfWeek::Monday, 535, id("A"), id("C"));
+  REQUIRE(crossing.first == Catch::Approx(a_to_b + 1));
+  REQUIRE(crossing.second.size() == 3);
+  REQUIRE(small_engine.GetQuickestPath(Month::July, DayOfWeek::Monday, 480, id("A"), id("C")).first ==
+          Catch::Approx(540 + 1 - 480));
+  REQUIRE(small_engine.GetQuickestPath(Month::July, DayOfWeek::Monday, 600, id("C"), id("A")).first ==
+          std::numeric_limits<double>::infinity());
+  // Around midnight Monday's evening is interpolated towards Tuesday's early morning
+  REQUIRE(small_engine.EdgeTime(Month::July, DayOfWeek::Monday, id("A"), id("B"), 1410) ==
+          Catch::Approx(6 + (4 - 6) * (1410.0 - 1320) / (1590 - 1320)));
+  REQUIRE(small_engine.GetQuickestPath(Month::July, DayOfWeek::Monday, 1410, id("A"), id("B")).first ==
+          Catch::Approx(6 + (4 - 6) * (1410.0 - 1320) / (1590 - 1320)));
+  // The evening is clamped to 600 - 240 and Monday's early morning to that minus 270; both sides of midnight
+  // interpolate between the clamped weights, so arrivals agree there
+  const double before_midnight =
+      1439.99 + small_engine.EdgeTime(Month::July, DayOfWeek::Sunday, id("D"), id("E"), 1439.99);
+  const double after_midnight = 1440 + small_engine.EdgeTime(Month::July, DayOfWeek::Monday, id("D"), id("E"), 0);
+  REQUIRE(after_midnight >= before_midnight);
+  REQUIRE(after_midnight == Catch::Approx(1440 + 360 + (90 - 360) * 120.0 / 270));
+  REQUIRE(before_midnight == Catch::Approx(after_midnight).margin(0.01));
+  REQUIRE(small_engine.GetQuickestPath(Month::July, DayOfWeek::Friday, 535, id("A"), id("B")).first == -1);
+  REQUIRE(small_engine.GetQuickestPath(Month::July, DayOfWeek::Monday, 535, id("A"), 99).first == -1);
+
+  // On the real network: edges cost their slice's time at bucket midpoints, leaving later never arrives
+  // earlier, and the reported time is the sum of the edge times at the times they are reached
+  AdjacencyList adj_list;
+  adj_list.LoadFromCSV("../data/subway_travel_times.csv");
+  TimeDependentDijkstra engine(&adj_list);
+  engine.Build();
+  const TimeSlice slice = adj_list.GetTimeSlices().front();
+  const Month month = slice.GetMonth();
+  const DayOfWeek day = slice.GetDayOfWeek();
+  const double midpoints[] = {150, 420, 750, 1080, 1320};
+  const CsrGraph* graph = adj_list.GetCsrGraph(slice);
+  const int station_count = adj_list.GetStationCount();
+  for (int from_id = 0; from_id < station_count; from_id += 5) {
+    for (int edge = graph->offsets[from_id]; edge < graph->offsets[from_id + 1]; ++edge) {
+      const int to_id = graph->targets[edge];
+      if (to_id == from_id) {
+        continue;
+      }
+      REQUIRE(engine.EdgeTime(month, day, from_id, to_id, midpoints[static_cast<int>(slice.GetTimeOfDay())]) ==
+              Catch::Approx(graph->EdgeWeight(from_id, to_id)));
+    }
+  }
+
+  // Arrival times keep rising through every day of the week and on across midnight into the next day
+  for (int weekday = 0; weekday < 7; ++weekday) {
+    const DayOfWeek today = static_cast<DayOfWeek>(weekday);
+    const DayOfWeek tomorrow = static_cast<DayOfWeek>((weekday + 1) % 7);
+    for (int from_id = 0; from_id < station_count; from_id += 3) {
+      for (int edge = graph->offsets[from_id]; edge < graph->offsets[from_id + 1]; ++edge) {
+        const int to_id = graph->targets[edge];
+        if (std::isinf(engine.EdgeTime(month, today, from_id, to_id, 0))) {
+          continue;
+        }
+        double previous_arrival = -1;
+        bool fifo = true;
+        for (double minute = 0; minute < TimeDependentDijkstra::kMinutesPerDay; ++minute) {
+          const double arrival = minute + engine.EdgeTime(month, today, from_id, to_id, minute);
+          fifo = fifo && arrival >= previous_arrival - 1e-9;
+          previous_arrival = arrival;
+        }
+        const double before_midnight = 1439.99 + engine.EdgeTime(month, today, from_id, to_id, 1439.99);
+        fifo = fifo && before_midnight >= previous_arrival - 1e-9;
+        const double after_midnight =
+            TimeDependentDijkstra::kMinutesPerDay + engine.EdgeTime(month, tomorrow, from_id, to_id, 0);
+        REQUIRE(fifo);
+        REQUIRE(after_midnight >= before_midnight - 1e-9);
+      }
+    }
+  }
+
+  for (int start_id = 0; start_id < station_count; start_id += 43) {
+    for (int end_id = 7; end_id < station_count; end_id += 59) {
+      double previous_arrival = -1;
+      for (double departure : {500.0, 530.0, 535.0, 540.0, 570.0, 1380.0, 1430.0, 1450.0}) {
+        auto result = engine.GetQuickestPath(month, day, departure, start_id, end_id);
+        if (result.second.empty()) {
+          continue;
+        }
+        const double arrival = departure + result.first;
+        REQUIRE(arrival >= previous_arrival - 1e-9);
+        previous_arrival = arrival;
+
+        double time = departure;
+        for (std::size_t i = 0; i + 1 < result.second.size(); ++i) {
+          const int from_id = adj_list.GetStationId(result.second[i]);
+          const int to_id = adj_list.GetStationId(result.second[i + 1]);
+          const int day_offset = static_cast<int>(time / TimeDependentDijkstra::kMinutesPerDay);
+          time += engine.EdgeTime(month, static_cast<DayOfWeek>((static_cast<int>(day) + day_offset) % 7), from_id,
+                                  to_id, time - day_offset * TimeDependentDijkstra::kMinutesPerDay);
+        }
+        REQUIRE(time == Catch::Approx(arrival).epsilon(1e-12));
+      }
+    }
+  }
+}
+
+TEST_CASE("Priority Queues Pop In Key Order", "[priority_queue]") {
+  for (QueueType queue_type : {QueueType::BinaryHeap, QueueType::QuaternaryHeap, QueueType::RadixHeap}) {
+    auto queue = MakeMinQueue(queue_type);
+    queue->Reset(8);
+    queue->Push(0, 4.5);
+    queue->Push(1, 1.37);
+    queue->Push(2, 9.0);
+    queue->Push(3, 0.0);
+    queue->Push(2, 2.25);  // Decrease-key for indexed queues, a second entry for lazy ones
+
+    std::vector<double> popped;
+    while (!queue->Empty()) {
+      popped.push_back(queue->Pop().key);
+    }
+    REQUIRE(popped.front() == 0.0);
+    REQUIRE(std::is_sorted(popped.begin(), popped.end()));
+    REQUIRE(popped.size() == (queue_type == QueueType::QuaternaryHeap ? 4u : 5u));
+  }
+}
+
+TEST_CASE("Dijkstra Finds The Same Times With Every Queue", "[dijkstra][priority_queue]") {
+  AdjacencyList queue_list;
+  queue_list.LoadFromCSV("../data/subway_travel_times.csv", CsvLoadMode::Mapped);
+  Dijkstra binary(&queue_list, QueueType::BinaryHeap);
+  Dijkstra quaternary(&queue_list, QueueType::QuaternaryHeap);
+  Dijkstra radix(&queue_list, QueueType::RadixHeap);
+  for (Dijkstra* engine : {&binary, &quaternary, &radix}) {
+    engine->SetCompositeKey({"October", "morning_rush", "Wednesday"});
+  }
+
+  for (int start_id = 0; start_id < queue_list.GetStationCount(); start_id += 41) {
+    for (int end_id = 0; end_id < queue_list.GetStationCount(); end_id += 29) {
+      const Station& start_station = *queue_list.GetStation(start_id);
+      const Station& end_station = *queue_list.GetStation(end_id);
+      const double expected = binary.GetQuickestPath(start_station, end_station).first;
+      REQUIRE(radix.GetQuickestPath(start_station, end_station).first == expected);
+
+      // The indexed heap inserts every station at most once per search
+      SearchStats stats;
+      const TimeSlice slice = TimeSlice::FromCompositeKey({"October", "morning_rush", "Wednesday"});
+      REQUIRE(quaternary.GetQuickestPath(slice, start_id, end_id, &stats).first == expected);
+      REQUIRE(stats.pushes <= static_cast<std::uint64_t>(queue_list.GetStationCount()));
+    }
+  }
+}
+
+TEST_CASE("Shared Engines Answer Concurrent Queries", "[dijkstra][astar][concurrency]") {
+  AdjacencyList shared_list;
+  shared_list.LoadFromCSV("../data/subway_travel_times.csv", CsvLoadMode::Mapped);
+  const Dijkstra shared_dijkstra(&shared_list);
+  const AStar shared_astar(&shared_list);
+  const std::vector<TimeSlice> slices = shared_list.GetTimeSlices();
+
+  // Answer every query once on this thread, then again from several threads sharing the same engines
+  struct Answer {
+    std::pair<double, std::vector<Station>> dijkstra;
+    std::pair<double, std::vector<Station>> astar;
+  };
+  auto answer = [&](std::size_t query) {
+    const TimeSlice slice = slices[query % slices.size()];
+    const int start_id = static_cast<int>(query * 7 % shared_list.GetStationCount());
+    const int end_id = static_cast<int>(query * 13 % shared_list.GetStationCount());
+    return Answer{shared_dijkstra.GetQuickestPath(slice, start_id, end_id),
+                  shared_astar.GetQuickestPath(slice, start_id, end_id)};
+  };
+
+  const std::size_t query_count = 400;
+  std::vector<Answer> expected;
+  for (std::size_t query = 0; query < query_count; ++query) {
+    expected.push_back(answer(query));
+  }
+
+  std::vector<Answer> concurrent(query_count);
+  std::vector<std::thread> workers;
+  for (std::size_t worker = 0; worker < 4; ++worker) {
+    workers.emplace_back([&, worker]() {
+      for (std::size_t query = worker; query < query_count; query += 4) {
+        concurrent[query] = answer(query);
+      }
+    });
+  }
+  for (auto& worker : workers) {
+    worker.join();
+  }
+
+  for (std::size_t query = 0; query < query_count; ++query) {
+    REQUIRE(concurrent[query].dijkstra == expected[query].dijkstra);
+    REQUIRE(concurrent[query].astar == expected[query].astar);
+  }
+}
+
+TEST_CASE("Parallel Loops Reuse The Pool Threads", "[concurrency]") {
+  // Every index runs exactly once, whichever thread picks it up
+  std::vector<std::atomic<int>> visits(1000);
+  ParallelFor(visits.size(), 4, [&visits](std::size_t i) { ++visits[i]; });
+  REQUIRE(std::all_of(visits.begin(), visits.end(), [](const std::atomic<int>& count) { return count == 1; }));
+
+  // Later loops run on the threads the first one started instead of starting their own
+  const std::size_t pool_threads = WorkerPool::Shared().ThreadCount();
+  for (int loop = 0; loop < 50; ++loop) {
+    std::atomic<std::size_t> sum(0);
+    ParallelFor(100, 4, [&sum](std::size_t i) {
+      sum += i;
+      std::this_thread::sleep_for(std::chrono::microseconds(50));
+    });
+    REQUIRE(sum == 4950);
+  }
+  REQUIRE(WorkerPool::Shared().ThreadCount() < pool_threads + 50);
+
+  // A throwing body stops the loop and the exception reaches the caller
+  REQUIRE_THROWS_AS(ParallelFor(100, 4,
+                                [](std::size_t i) {
+                                  if (i == 7) {
+                                    throw std::runtime_error("index 7");
+                                  }
+                                }),
+                    std::runtime_error);
+}
+
+TEST_CASE("Server Config Reads Flags And Config File", "[server_config]") {
+  const std::string config_path = "server_config_test.conf";
+  {
+    std::ofstream config_file(config_path);
+    config_file << "# load test profile\n"
+                << "threads = 12\n"
+                << "keep-alive-max=50   # per connection\n"
+                << "port = 9000\n";
+  }
+
+  ServerConfig config;
+  std::string error;
+  const char* argv[] = {"subway_server", "--config", config_path.c_str(), "--port=8081",
+                        "--host", "0.0.0.0", "--max-payload", "4096"};
+  REQUIRE(ParseServerConfig(8, argv, config, error));
+  REQUIRE(config.worker_threads == 12);
+  REQUIRE(config.keep_alive_max_count == 50);
+  REQUIRE(config.port == 8081);  // flags after --config override the file
+  REQUIRE(config.host == "0.0.0.0");
+  REQUIRE(config.payload_max_length == 4096);
+  REQUIRE(config.read_timeout == 5);
+  REQUIRE(config.batch_threads == 0);  // batches fan out over the pool unless configured
+  std::remove(config_path.c_str());
+
+  ServerConfig rejected;
+  const char* bad_value[] = {"subway_server", "--threads", "many"};
+  REQUIRE_FALSE(ParseServerConfig(3, bad_value, rejected, error));
+  const char* unknown[] = {"subway_server", "--workers=4"};
+  REQUIRE_FALSE(ParseServerConfig(2, unknown, rejected, error));
+  const char* missing_value[] = {"subway_server", "--port"};
+  REQUIRE_FALSE(ParseServerConfig(2, missing_value, rejected, error));
+}
+
+TEST_CASE("Route Cache Hits, Evicts And Invalidates", "[route_cache]") {
+  const TimeSlice slice = TimeSlice::FromIndex(0);
+  const CachedRoute route{3.5, {"1 Av", "3 Av", "Union Sq - 14 St"}};
+
+  // Single shard so the eviction order is deterministic
+  RouteCache cache(4096, 1);
+  const std::uint64_t key = RouteCache::MakeKey(slice, 1, 2);
+  REQUIRE(key != RouteCache::MakeKey(slice, 2, 1));
+  REQUIRE(key != RouteCache::MakeKey(TimeSlice::FromIndex(1), 1, 2));
+
+  REQUIRE(cache.Get(key) == nullptr);
+  cache.Put(key, route, cache.Generation());
+  auto hit = cache.Get(key);
+  REQUIRE(hit != nullptr);
+  REQUIRE(hit->estimated_time_minutes == 3.5);
+  REQUIRE(hit->route == route.route);
+
+  // Filling the shard past its budget evicts least recently used routes first
+  for (int end_id = 100; end_id < 200; ++end_id) {
+    cache.Get(key);
+    cache.Put(RouteCache::MakeKey(slice, 1, end_id), route, cache.Generation());
+  }
+  RouteCacheStats stats = cache.GetStats();
+  REQUIRE(stats.bytes <= stats.capacity_bytes);
+  REQUIRE(stats.evictions > 0);
+  REQUIRE(cache.Get(key) != nullptr);
+  REQUIRE(cache.Get(RouteCache::MakeKey(slice, 1, 100)) == nullptr);
+  REQUIRE(cache.GetStats().hits == 102);
+  REQUIRE(cache.GetStats().misses == 2);
+
+  // Invalidation drops everything, and results computed before it are not cached afterwards
+  const std::uint64_t old_generation = cache.Generation();
+  cache.Invalidate();
+  REQUIRE(cache.Get(key) == nullptr);
+  cache.Put(key, route, old_generation);
+  REQUIRE(cache.Get(key) == nullptr);
+  REQUIRE(cache.GetStats().entries == 0);
+
+  RouteCache disabled(0);
+  disabled.Put(key, route, disabled.Generation());
+  REQUIRE(disabled.Get(key) == nullptr);
+}
+
+TEST_CASE("Shortest Path Tables Match Dijkstra", "[shortest_path_table][dijkstra]") {
+  AdjacencyList adj_list;
+  adj_list.LoadFromCSV("../data/subway_travel_times.csv");
+  const std::vector<TimeSlice> slices = adj_list.GetTimeSlices();
+  REQUIRE(slices.size() >= 2);
+  const std::vector<TimeSlice> built{slices.front(), slices.back()};
+
+  ShortestPathTable table(&adj_list);
+  REQUIRE_FALSE(table.IsReady());
+  REQUIRE(table.Build(2, built));
+  REQUIRE(table.IsReady());
+  REQUIRE(table.GetReport().slices == 2);
+  REQUIRE(table.GetReport().searches == 2u * adj_list.GetStationCount());
+  REQUIRE(table.GetReport().table_bytes == 2u * adj_list.GetStationCount() * adj_list.GetStationCount() * 6);
+  REQUIRE_FALSE(table.HasSlice(slices[1]));
+
+  Dijkstra dijkstra(&adj_list);
+  const int station_count = adj_list.GetStationCount();
+  for (TimeSlice slice : built) {
+    for (int start_id = 0; start_id < station_count; start_id += 7) {
+      for (int end_id = 0; end_id < station_count; end_id += 11) {
+        auto expected = dijkstra.GetQuickestPath(slice, start_id, end_id);
+        auto actual = table.GetQuickestPath(slice, start_id, end_id);
+        REQUIRE(actual.first == Catch::Approx(expected.first).epsilon(1e-12));
+        REQUIRE(table.GetTime(slice, start_id, end_id) == Catch::Approx(expected.first).epsilon(1e-6));
+        REQUIRE(actual.second.empty() == expected.second.empty());
+        if (!expected.second.empty()) {
+          REQUIRE(actual.second.front().station_name == expected.second.front().station_name);
+          REQUIRE(actual.second.back().station_name == expected.second.back().station_name);
+        }
+      }
+    }
+  }
+  REQUIRE(table.GetQuickestPath(slices[1], 0, 1).first == -1);
+}
+
+TEST_CASE("Contraction Hierarchies Match Dijkstra", "[contraction_hierarchy][dijkstra]") {
+  AdjacencyList adj_list;
+  adj_list.LoadFromCSV("../data/subway_travel_times.csv");
+  const std::vector<TimeSlice> slices = adj_list.GetTimeSlices();
+  REQUIRE(slices.size() >= 2);
+  const std::vector<TimeSlice> built{slices.front(), slices.back()};
+
+  ContractionHierarchy hierarchy(&adj_list);
+  hierarchy.Build(2, built);
+  REQUIRE(hierarchy.HasSlice(slices.front()));
+  REQUIRE_FALSE(hierarchy.HasSlice(slices[1]));
+  REQUIRE(hierarchy.GetReport().slices == 2);
+
+  Dijkstra dijkstra(&adj_list);
+  const int station_count = adj_list.GetStationCount();
+  for (TimeSlice slice : built) {
+    for (int start_id = 0; start_id < station_count; start_id += 5) {
+      for (int end_id = 0; end_id < station_count; end_id += 3) {
+        auto expected = dijkstra.GetQuickestPath(slice, start_id, end_id);
+        SearchStats stats;
+        auto actual = hierarchy.GetQuickestPath(slice, start_id, end_id, &stats);
+        REQUIRE(actual.first == Catch::Approx(expected.first).epsilon(1e-12));
+        REQUIRE(actual.second.empty() == expected.second.empty());
+        if (!expected.second.empty()) {
+          REQUIRE(actual.second.front().station_name == expected.second.front().station_name);
+          REQUIRE(actual.second.back().station_name == expected.second.back().station_name);
+          REQUIRE(stats.settled > 0);
+        }
+      }
+    }
+  }
+  REQUIRE(hierarchy.GetQuickestPath(slices[1], 0, 1).first == -1);
+}
+
+TEST_CASE("Distance Matrices Match Dijkstra", "[distance_matrix][contraction_hierarchy][dijkstra]") {
+  AdjacencyList adj_list;
+  adj_list.LoadFromCSV("../data/subway_travel_times.csv");
+  const std::vector<TimeSlice> slices = adj_list.GetTimeSlices();
+  REQUIRE(slices.size() >= 2);
+
+  ContractionHierarchy hierarchy(&adj_list);
+  hierarchy.Build(2, {slices.front()});
+  DistanceMatrix matrix(&adj_list, &hierarchy);
+  REQUIRE(matrix.HasBuckets(slices.front()));
+  REQUIRE_FALSE(matrix.HasBuckets(slices[1]));
+
+  Dijkstra dijkstra(&adj_list);
+  const int station_count = adj_list.GetStationCount();
+  std::vector<int> sources;
+  for (int station_id = 0; station_id < station_count; station_id += 7) {
+    sources.push_back(station_id);
+  }
+  std::vector<int> targets = {sources[3], 0};
+  for (int station_id = 2; station_id < station_count; station_id += 11) {
+    targets.push_back(station_id);
+  }
+
+  for (MatrixAlgorithm algorithm : {MatrixAlgorithm::OneToAll, MatrixAlgorithm::Buckets}) {
+    for (unsigned int threads : {1u, 3u}) {
+      std::vector<double> times;
+      SearchStats stats;
+      REQUIRE(matrix.Compute(slices.front(), sources, targets, algorithm, times, threads, &stats));
+      REQUIRE(times.size() == sources.size() * targets.size());
+      REQUIRE(stats.settled > 0);
+      for (std::size_t i = 0; i < sources.size(); ++i) {
+        for (std::size_t j = 0; j < targets.size(); ++j) {
+          const double expected = dijkstra.GetQuickestPath(slices.front(), sources[i], targets[j]).first;
+          REQUIRE(times[i * targets.size() + j] == Catch::Approx(expected).epsilon(1e-12));
+        }
+      }
+    }
+  }
+
+  // Bad stations get the engines' sentinel; a slice without a hierarchy cannot use buckets
+  std::vector<double> times;
+  REQUIRE(matrix.Compute(slices.front(), {0, -1}, {1, station_count}, MatrixAlgorithm::Buckets, times, 1));
+  REQUIRE(times == std::vector<double>{dijkstra.GetQuickestPath(slices.front(), 0, 1).first, -1, -1, -1});
+  REQUIRE(matrix.Compute(slices.front(), {0, -1}, {1, station_count}, MatrixAlgorithm::OneToAll, times, 1));
+  REQUIRE(times == std::vector<double>{dijkstra.GetQuickestPath(slices.front(), 0, 1).first, -1, -1, -1});
+  REQUIRE(matrix.Compute(slices[1], {0}, {1}, MatrixAlgorithm::OneToAll, times, 1));
+  REQUIRE_FALSE(matrix.Compute(slices[1], {0}, {1}, MatrixAlgorithm::Buckets, times, 1));
+  REQUIRE_FALSE(matrix.Compute(TimeSlice(), {0}, {1}, MatrixAlgorithm::OneToAll, times, 1));
+}
+
+TEST_CASE("Bidirectional Dijkstra Matches Dijkstra", "[bidirectional_dijkstra][dijkstra]") {
+  AdjacencyList adj_list;
+  adj_list.LoadFromCSV("../data/subway_travel_times.csv");
+  const std::vector<TimeSlice> slices = adj_list.GetTimeSlices();
+  REQUIRE_FALSE(slices.empty());
+
+  // The reverse graph holds the same edges, grouped by arrival station
+  const CsrGraph& graph = *adj_list.GetCsrGraph(slices.front());
+  const CsrGraph& reverse = *adj_list.GetReverseCsrGraph(slices.front());
+  REQUIRE(reverse.StationCount() == graph.StationCount());
+  REQUIRE(reverse.targets.size() == graph.targets.size());
+  for (int station_id = 0; station_id < graph.StationCount(); ++station_id) {
+    for (int edge = graph.offsets[station_id]; edge < graph.offsets[station_id + 1]; ++edge) {
+      const int end_id = graph.targets[edge];
+      bool found = false;
+      for (int back = reverse.offsets[end_id]; back < reverse.offsets[end_id + 1]; ++back) {
+        found = found || (reverse.targets[back] == station_id && reverse.weights[back] == graph.weights[edge]);
+      }
+      REQUIRE(found);
+    }
+  }
+
+  Dijkstra dijkstra(&adj_list);
+  const int station_count = adj_list.GetStationCount();
+  for (QueueType queue_type : {QueueType::BinaryHeap, QueueType::QuaternaryHeap, QueueType::RadixHeap}) {
+    BidirectionalDijkstra bidirectional(&adj_list, queue_type);
+    for (std::size_t slice_index = 0; slice_index < slices.size(); slice_index += 40) {
+      const TimeSlice slice = slices[slice_index];
+      for (int start_id = 0; start_id < station_count; start_id += 9) {
+        for (int end_id = 0; end_id < station_count; end_id += 7) {
+          auto expected = dijkstra.GetQuickestPath(slice, start_id, end_id);
+          auto actual = bidirectional.GetQuickestPath(slice, start_id, end_id);
+          REQUIRE(actual.first == Catch::Approx(expected.first).epsilon(1e-12));
+          REQUIRE(actual.second.empty() == expected.second.empty());
+          if (!expected.second.empty()) {
+            REQUIRE(actual.second.front().station_name == expected.second.front().station_name);
+            REQUIRE(actual.second.back().station_name == expected.second.back().station_name);
+          }
+        }
+      }
+    }
+  }
+}
+
+TEST_CASE("A* With Landmarks Matches Dijkstra And Settles Fewer Stations", "[astar][landmarks]") {
+  AdjacencyList adj_list;
+  adj_list.LoadFromCSV("../data/subway_travel_times.csv");
+  const std::vector<TimeSlice> slices = adj_list.GetTimeSlices();
+
+  LandmarkTable landmarks(&adj_list);
+  landmarks.Build(8, 2);
+  REQUIRE(landmarks.GetSlice(slices.front()) != nullptr);
+  REQUIRE(landmarks.GetSlice(slices.front())->landmarks.size() == 8);
+
+  Dijkstra dijkstra(&adj_list);
+  AStar coordinate_astar(&adj_list);
+  const int station_count = adj_list.GetStationCount();
+  SearchStats dijkstra_stats;
+  SearchStats coordinate_stats;
+  for (QueueType queue_type : {QueueType::BinaryHeap, QueueType::QuaternaryHeap, QueueType::RadixHeap}) {
+    AStar landmark_astar(&adj_list, queue_type);
+    landmark_astar.SetLandmarks(&landmarks);
+    SearchStats landmark_stats;
+    dijkstra_stats = SearchStats();
+    coordinate_stats = SearchStats();
+    for (std::size_t slice_index = 0; slice_index < slices.size(); slice_index += 25) {
+      const TimeSlice slice = slices[slice_index];
+      for (int start_id = 0; start_id < station_count; start_id += 11) {
+        for (int end_id = 3; end_id < station_count; end_id += 13) {
+          auto expected = dijkstra.GetQuickestPath(slice, start_id, end_id, &dijkstra_stats);
+          coordinate_astar.GetQuickestPath(slice, start_id, end_id, &coordinate_stats);
+          auto actual = landmark_astar.GetQuickestPath(slice, start_id, end_id, &landmark_stats);
+          // A* reports unreachable stations as -1 where Dijkstra reports infinity
+          if (expected.second.empty()) {
+            REQUIRE(actual.first == -1);
+          } else {
+            REQUIRE(actual.first == Catch::Approx(expected.first).epsilon(1e-12));
+          }
+          REQUIRE(actual.second.empty() == expected.second.empty());
+        }
+      }
+    }
+    REQUIRE(landmark_stats.settled < coordinate_stats.settled);
+    REQUIRE(landmark_stats.settled < dijkstra_stats.settled);
+  }
+}
+
+TEST_CASE("Search Traces Match Search Stats", "[dijkstra][astar][bidirectional_dijkstra][search_trace]") {
+  AdjacencyList adj_list;
+  adj_list.LoadFromCSV("../data/subway_travel_times.csv");
+  const std::vector<TimeSlice> slices = adj_list.GetTimeSlices();
+  REQUIRE_FALSE(slices.empty());
+
+  LandmarkTable landmarks(&adj_list);
+  landmarks.Build(4, 2);
+  Dijkstra dijkstra(&adj_list);
+  AStar astar(&adj_list);
+  astar.SetLandmarks(&landmarks);
+  BidirectionalDijkstra bidirectional(&adj_list);
+
+  // Every counter of the trace agrees with the engine's own stats, and a traced search finds the same route
+  auto check = [](const RecordingTrace& trace, const SearchStats& stats) {
+    REQUIRE(trace.settled.size() == stats.settled);
+    REQUIRE(trace.relaxations == stats.relaxed);
+    REQUIRE(trace.pushes == stats.pushes + stats.decrease_keys);
+    REQUIRE(trace.pops == stats.pops);
+    REQUIRE(trace.stale_pops + trace.settled.size() <= trace.pops);
+    REQUIRE(trace.improving_relaxations <= trace.relaxations);
+  };
+
+  const int station_count = adj_list.GetStationCount();
+  for (std::size_t slice_index = 0; slice_index < slices.size(); slice_index += 50) {
+    const TimeSlice slice = slices[slice_index];
+    for (int start_id = 0; start_id < station_count; start_id += 31) {
+      for (int end_id = 5; end_id < station_count; end_id += 37) {
+        RecordingTrace dijkstra_trace;
+        SearchStats dijkstra_stats;
+        auto traced = dijkstra.GetQuickestPath(slice, start_id, end_id, dijkstra_trace, &dijkstra_stats);
+        auto untraced = dijkstra.GetQuickestPath(slice, start_id, end_id);
+        REQUIRE(traced.first == untraced.first);
+        REQUIRE(traced.second.size() == untraced.second.size());
+        check(dijkstra_trace, dijkstra_stats);
+        // Dijkstra settles the start first and stops as soon as it settles the end
+        REQUIRE(dijkstra_trace.settled.front() == start_id);
+        if (!traced.second.empty()) {
+          REQUIRE(dijkstra_trace.settled.back() == end_id);
+        }
+
+        RecordingTrace astar_trace;
+        SearchStats astar_stats;
+        auto astar_result = astar.GetQuickestPath(slice, start_id, end_id, astar_trace, &astar_stats);
+        REQUIRE(astar_result.first == astar.GetQuickestPath(slice, start_id, end_id).first);
+        check(astar_trace, astar_stats);
+        REQUIRE(astar_trace.settled.front() == start_id);
+
+        RecordingTrace bidirectional_trace;
+        SearchStats bidirectional_stats;
+        auto bidirectional_result =
+            bidirectional.GetQuickestPath(slice, start_id, end_id, bidirectional_trace, &bidirectional_stats);
+        REQUIRE(bidirectional_result.first == bidirectional.GetQuickestPath(slice, start_id, end_id).first);
+        check(bidirectional_trace, bidirectional_stats);
+      }
+    }
+  }
+}
+
+TEST_CASE("Latency Histogram Percentiles And Concurrent Recording", "[latency_histogram]") {
+  LatencyHistogram histogram;
+  REQUIRE(histogram.GetCount() == 0);
+  REQUIRE(histogram.ValueAtPercentile(99) == 0);
+  REQUIRE(histogram.GetMin() == 0);
+
+  // Small values are exact, large ones within 1/128
+  for (std::uint64_t value = 1; value <= 100000; ++value) {
+    histogram.Record(value);
+  }
+  REQUIRE(histogram.GetCount() == 100000);
+  REQUIRE(histogram.GetMin() == 1);
+  REQUIRE(histogram.GetMax() == 100000);
+  REQUIRE(histogram.GetMean() == Catch::Approx(50000.5));
+  REQUIRE(histogram.ValueAtPercentile(0.1) == 100);
+  for (double percentile : {50.0, 90.0, 99.0, 99.9}) {
+    const double exact = percentile * 1000.0;
+    REQUIRE(histogram.ValueAtPercentile(percentile) >= exact);
+    REQUIRE(histogram.ValueAtPercentile(percentile) <= exact * (1.0 + 1.0 / 128));
+  }
+  REQUIRE(histogram.ValueAtPercentile(100) == 100000);
+  REQUIRE(histogram.CountAtOrBelow(255) == 255);
+  REQUIRE(histogram.CountAtOrBelow(0) == 0);
+  REQUIRE(histogram.CountAtOrBelow(LatencyHistogram::kMaxValue) == 100000);
+
+  // Values past the range are clamped instead of lost
+  histogram.Record(LatencyHistogram::kMaxValue * 4);
+  REQUIRE(histogram.GetMax() == LatencyHistogram::kMaxValue);
+  histogram.Reset();
+  REQUIRE(histogram.GetCount() == 0);
+  REQUIRE(histogram.GetMax() == 0);
+
+  // Threads record into one histogram without losing counts, and merging adds them up
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 4; ++t) {
+    threads.emplace_back([&histogram, t]() {
+      for (std::uint64_t value = 0; value < 50000; ++value) {
+        histogram.Record(value * (t + 1));
+      }
+    });
+  }
+  for (std::thread& thread : threads) {
+    thread.join();
+  }
+  REQUIRE(histogram.GetCount() == 200000);
+  REQUIRE(histogram.GetMax() == 49999 * 4);
+  LatencyHistogram merged;
+  merged.Record(7);
+  merged.Merge(histogram);
+  REQUIRE(merged.GetCount() == 200001);
+  REQUIRE(merged.GetSum() == histogram.GetSum() + 7);
+  REQUIRE(merged.GetMin() == 0);
+}
+
+TEST_CASE("Server Metrics Render Prometheus Text", "[server_metrics]") {
+  ServerMetrics metrics;
+  REQUIRE(ServerMetrics::EndpointForPath("/api/find-route") == ServerMetrics::Endpoint::FindRoute);
+  REQUIRE(ServerMetrics::EndpointForPath("/api/find-routes/batch") == ServerMetrics::Endpoint::FindRoutesBatch);
+  REQUIRE(ServerMetrics::EndpointForPath("/no/such/path") == ServerMetrics::Endpoint::Other);
+
+  metrics.RecordRequest(ServerMetrics::Endpoint::FindRoute, 200, 1500000);
+  metrics.RecordRequest(ServerMetrics::Endpoint::FindRoute, 200, 2500000);
+  metrics.RecordRequest(ServerMetrics::Endpoint::FindRoute, 400, 50000);
+  metrics.RecordStage(ServerMetrics::Stage::JsonParse, 3000);
+  metrics.RecordSearch(ServerMetrics::Algorithm::Dijkstra, 200000, 150);
+  RouteCacheStats cache_stats;
+  cache_stats.hits = 7;
+  const std::string text = metrics.Render(cache_stats);
+
+  auto has_line = [&text](const std::string& line) { return text.find(line + "\n") != std::string::npos; };
+  REQUIRE(has_line("# TYPE subway_http_requests_total counter"));
+  REQUIRE(has_line("subway_http_requests_total{endpoint=\"/api/find-route\",status=\"200\"} 2"));
+  REQUIRE(has_line("subway_http_requests_total{endpoint=\"/api/find-route\",status=\"400\"} 1"));
+  // Only statuses that occurred are exported
+  REQUIRE(text.find("endpoint=\"/health\",status=") == std::string::npos);
+  // Buckets are cumulative and in seconds
+  REQUIRE(has_line("subway_http_request_duration_seconds_bucket{endpoint=\"/api/find-route\",le=\"0.001\"} 1"));
+  REQUIRE(has_line("subway_http_request_duration_seconds_bucket{endpoint=\"/api/find-route\",le=\"0.0025\"} 3"));
+  REQUIRE(has_line("subway_http_request_duration_seconds_bucket{endpoint=\"/api/find-route\",le=\"0.005\"} 3"));
+  REQUIRE(has_line("subway_http_request_duration_seconds_bucket{endpoint=\"/api/find-route\",le=\"+Inf\"} 3"));
+  REQUIRE(has_line("subway_http_request_duration_seconds_sum{endpoint=\"/api/find-route\"} 0.00405"));
+  REQUIRE(has_line("subway_http_request_duration_seconds_count{endpoint=\"/api/find-route\"} 3"));
+  REQUIRE(has_line("subway_stage_duration_seconds_count{stage=\"json_parse\"} 1"));
+  REQUIRE(has_line("subway_search_duration_seconds_count{algorithm=\"dijkstra\"} 1"));
+  REQUIRE(has_line("subway_search_settled_stations_bucket{algorithm=\"dijkstra\",le=\"100\"} 0"));
+  REQUIRE(has_line("subway_search_settled_stations_bucket{algorithm=\"dijkstra\",le=\"200\"} 1"));
+  REQUIRE(has_line("subway_route_cache_hits_total 7"));
+}
+
+TEST_CASE("Logger Writes Enabled Levels From Many Threads", "[logger]") {
+  LogLevel level = LogLevel::Off;
+  REQUIRE(ParseLogLevel("warning", level));
+  REQUIRE(level == LogLevel::Warning);
+  REQUIRE_FALSE(ParseLogLevel("verbose", level));
+
+  std::FILE* output = std::tmpfile();
+  REQUIRE(output != nullptr);
+  Logger& logger = Logger::Instance();
+  const LogLevel original_level = logger.GetLevel();
+  logger.SetOutput(output);
+  logger.SetLevel(LogLevel::Info);
+
+  // Debug is below the runtime level, so its message is never even formatted
+  int formatted = 0;
+  auto count_format = [&formatted]() { return ++formatted; };
+  LOG_DEBUG("hidden " << count_format());
+  REQUIRE(formatted == 0);
+  LOG_INFO("visible " << count_format());
+  REQUIRE(formatted == 1);
+
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 4; ++t) {
+    threads.emplace_back([t]() {
+      for (int i = 0; i < 500; ++i) {
+        LOG_WARNING("thread " << t << " line " << i);
+      }
+    });
+  }
+  for (std::thread& thread : threads) {
+    thread.join();
+  }
+  logger.Flush();
+  logger.SetOutput(stdout);
+  logger.SetLevel(original_level);
+
+  std::rewind(output);
+  int lines = 0;
+  int visible = 0;
+  char buffer[256];
+  while (std::fgets(buffer, sizeof(buffer), output)) {
+    const std::string line = buffer;
+    ++lines;
+    visible += line.find(" info    visible 1") != std::string::npos;
+    REQUIRE(line.find("hidden") == std::string::npos);
+  }
+  std::fclose(output);
+  REQUIRE(visible == 1);
+  // Every line is written unless the ring buffer overflowed, in which case it is counted instead
+  REQUIRE(lines + logger.DroppedCount() == 2001);
+}